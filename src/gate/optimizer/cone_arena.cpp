@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/cone_arena.h"
+
+#include <new>
+#include <type_traits>
+
+namespace eda::gate::optimizer {
+
+  /**
+   * \brief Nets constructed between two releases.
+   */
+  class ConeArena::Generation {
+  public:
+    using Slot = std::aligned_storage_t<sizeof(GNet), alignof(GNet)>;
+
+    explicit Generation(size_t chunkSize) : chunkSize(chunkSize) {}
+
+    ~Generation() {
+      for (size_t i = 0; i < size; ++i) {
+        at(i)->~GNet();
+      }
+    }
+
+    // Returns true if a chunk has been allocated.
+    bool emplace(GNet *&net) {
+      bool allocated = false;
+      if (size == chunks.size() * chunkSize) {
+        chunks.push_back(std::make_unique<Slot[]>(chunkSize));
+        allocated = true;
+      }
+      net = new (&chunks[size / chunkSize][size % chunkSize]) GNet();
+      ++size;
+      return allocated;
+    }
+
+    size_t count() const { return size; }
+
+  private:
+    GNet *at(size_t i) {
+      return std::launder(
+          reinterpret_cast<GNet*>(&chunks[i / chunkSize][i % chunkSize]));
+    }
+
+    const size_t chunkSize;
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    size_t size = 0;
+  };
+
+  ConeArena::ConeArena(size_t chunkSize) :
+      chunkSize(chunkSize ? chunkSize : 1),
+      generation(std::make_shared<Generation>(this->chunkSize)) {}
+
+  ConeArena::GNet *ConeArena::create() {
+    GNet *net;
+    bool allocated;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      allocated = generation->emplace(net);
+    }
+    nets.fetch_add(1, std::memory_order_relaxed);
+    if (allocated) {
+      chunks.fetch_add(1, std::memory_order_relaxed);
+    }
+    return net;
+  }
+
+  std::shared_ptr<ConeArena::GNet> ConeArena::share(GNet *net) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::shared_ptr<GNet>(generation, net);
+  }
+
+  void ConeArena::release() {
+    auto next = std::make_shared<Generation>(chunkSize);
+    std::lock_guard<std::mutex> lock(mutex);
+    generation.swap(next);
+    ++releases;
+    // The previous generation is destroyed after the unlock unless shared.
+  }
+
+  ConeArena::Stats ConeArena::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats stats;
+    stats.nets = nets.load(std::memory_order_relaxed);
+    stats.chunks = chunks.load(std::memory_order_relaxed);
+    stats.liveNets = generation->count();
+    stats.releases = releases;
+    return stats;
+  }
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Pool of the nets of extracted cones.
+  * \ The nets are constructed in chunks of preallocated storage and are
+  * \ destroyed together when the arena is released. Shared pointers to the
+  * \ nets share the control block of their chunk list, so a pointer keeps
+  * \ all the nets of its generation alive after release(), and no control
+  * \ block is allocated per net. The gates are allocated by the nets.
+  */
+  class ConeArena {
+
+  public:
+    using GNet = model::GNet;
+
+    /// Allocation counters.
+    struct Stats {
+      // Nets constructed since the arena creation.
+      size_t nets = 0;
+      // Chunks allocated since the arena creation.
+      size_t chunks = 0;
+      // Nets of the current generation.
+      size_t liveNets = 0;
+      // Number of release() calls.
+      size_t releases = 0;
+    };
+
+    /**
+     * @param chunkSize Number of nets in a chunk of storage.
+     */
+    explicit ConeArena(size_t chunkSize = 256);
+
+    ConeArena(const ConeArena &) = delete;
+    ConeArena &operator=(const ConeArena &) = delete;
+
+    /**
+     * Constructs an empty net owned by the arena (thread-safe).
+     * The net must not be deleted.
+     */
+    GNet *create();
+
+    /**
+     * Returns a pointer sharing the ownership of the net generation.
+     * @param net Net created by the arena since the last release.
+     */
+    std::shared_ptr<GNet> share(GNet *net) const;
+
+    /**
+     * Releases the nets of the current generation. The nets are destroyed
+     * at once when no shared pointer to them is left.
+     */
+    void release();
+
+    Stats getStats() const;
+
+  private:
+    class Generation;
+
+    const size_t chunkSize;
+
+    mutable std::mutex mutex;
+    std::shared_ptr<Generation> generation;
+
+    std::atomic<size_t> nets{0};
+    std::atomic<size_t> chunks{0};
+    size_t releases = 0;
+  };
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,40 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+namespace eda::gate::optimizer {
+
+  // CONE_COMPLETE - the whole cone is traced.
+  // CONE_DEPTH_LIMIT - the nodes at the max depth have not traced neighbours.
+  // CONE_SIZE_LIMIT - the cone has more nodes than the budget.
+
+  enum ConeStatus {
+    CONE_COMPLETE,
+    CONE_DEPTH_LIMIT,
+    CONE_SIZE_LIMIT
+  };
+
+ /**
+  * \brief Bounds of a cone traversal.
+  * \ The depth of the cone vertex is 0, the depth of a node is the length
+  * \ of the shortest path from the vertex to it. Nodes at the max depth are
+  * \ added to the cone, but their neighbours are not. The traversal stops
+  * \ as soon as the cone has maxNodes nodes and one more node is reached.
+  */
+  struct ConeLimits {
+    static constexpr size_t NO_LIMIT = std::numeric_limits<size_t>::max();
+
+    size_t maxDepth = NO_LIMIT;
+    size_t maxNodes = NO_LIMIT;
+  };
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,226 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/cone_view.h"
+#include "gate/optimizer/cut_truth_table.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace eda::gate::optimizer {
+
+  using Gate = model::Gate;
+  using GateSymbol = model::GateSymbol;
+
+  // Tables of the variables (see cut_truth_table.h).
+  static constexpr uint64_t VAR_TABLES[] = {
+    0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+    0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+  };
+
+  uint32_t ConeView::getLeafIndex(GateId leaf) const {
+    auto found = cut.find(leaf);
+    return found == cut.end() ? NO_LEAF : found - cut.begin();
+  }
+
+  bool ConeView::simulate(const std::vector<uint64_t> &leafValues,
+                          std::vector<uint64_t> &values,
+                          uint64_t &result) const {
+    thread_local std::vector<uint64_t> inputs;
+
+    values.resize(nNodes);
+    for (size_t i = 0; i < nNodes; ++i) {
+      const GateSymbol func = Gate::get(nodes[i])->func();
+      if (func == GateSymbol::ZERO || func == GateSymbol::ONE) {
+        values[i] = func == GateSymbol::ZERO ? 0 : ~0ull;
+        continue;
+      }
+      if (leafIndices[i] != NO_LEAF) {
+        values[i] = leafValues[leafIndices[i]];
+        continue;
+      }
+
+      inputs.clear();
+      for (auto j = faninOffsets[i]; j < faninOffsets[i + 1]; ++j) {
+        inputs.push_back(values[fanins[j]]);
+      }
+      if (!evaluateCutTable(func, inputs, values[i])) {
+        return false;
+      }
+    }
+    result = values[nNodes - 1];
+    return true;
+  }
+
+  bool ConeView::getTruthTable(uint64_t &table) const {
+    if (cut.size() > std::size(VAR_TABLES)) {
+      return false;
+    }
+    std::vector<uint64_t> leafValues(VAR_TABLES, VAR_TABLES + cut.size());
+    return simulate(leafValues, scratch(), table);
+  }
+
+  void ConeView::getHeights(int &maxHeight, int &minHeight) const {
+    minHeight = std::numeric_limits<int>::max();
+    maxHeight = -1;
+    if (leafIndices[nNodes - 1] != NO_LEAF) {
+      minHeight = maxHeight = 0;
+      return;
+    }
+
+    // The nodes are handled after all their fanouts in the cone.
+    std::vector<int> heights(nNodes, std::numeric_limits<int>::max());
+    heights[nNodes - 1] = 0;
+    for (size_t i = nNodes; i-- > 0;) {
+      if (leafIndices[i] != NO_LEAF) {
+        continue;
+      }
+      const int height = heights[i] + 1;
+      for (auto j = faninOffsets[i]; j < faninOffsets[i + 1]; ++j) {
+        const auto fanin = fanins[j];
+        if (leafIndices[fanin] != NO_LEAF) {
+          minHeight = std::min(minHeight, height);
+          maxHeight = std::max(maxHeight, height);
+        } else {
+          heights[fanin] = std::min(heights[fanin], height);
+        }
+      }
+    }
+  }
+
+  BoundGNet ConeView::materialize(const std::vector<GateId> &order,
+                                  ConeArena *arena) const {
+    GNet *net = arena ? arena->create() : new GNet();
+    std::vector<GateId> newGates(nNodes);
+    std::vector<GateId> newLeaves(cut.size(), 0);
+
+    for (size_t i = 0; i < nNodes; ++i) {
+      Gate *gate = Gate::get(nodes[i]);
+      if (leafIndices[i] != NO_LEAF) {
+        auto func = gate->isValue() ? gate->func() : GateSymbol::IN;
+        newGates[i] = net->addGate(func);
+        newLeaves[leafIndices[i]] = newGates[i];
+        continue;
+      }
+
+      std::vector<base::model::Signal<GateId>> signals;
+      signals.reserve(faninOffsets[i + 1] - faninOffsets[i]);
+      for (auto j = faninOffsets[i]; j < faninOffsets[i + 1]; ++j) {
+        signals.emplace_back(base::model::Event::ALWAYS, newGates[fanins[j]]);
+      }
+      newGates[i] = net->addGate(gate->func(), signals);
+    }
+    if (Gate::get(getRoot())->func() != GateSymbol::OUT) {
+      net->addOut(newGates[nNodes - 1]);
+    }
+
+    BoundGNet boundGNet;
+    boundGNet.net = arena ? arena->share(net) : std::shared_ptr<GNet>(net);
+    for (GateId gate: order) {
+      auto index = getLeafIndex(gate);
+      assert(index != NO_LEAF && "Leaf is not in the cut");
+      boundGNet.inputBindings.push_back(newLeaves[index]);
+    }
+    return boundGNet;
+  }
+
+  std::vector<uint64_t> &ConeView::scratch() const {
+    thread_local std::vector<uint64_t> values;
+    return values;
+  }
+
+  ConeViewBuilder::ConeViewBuilder(const CsrGraph *graph) : graph(graph) {}
+
+  size_t ConeViewBuilder::getFaninsNumber(GateId node) const {
+    if (graph) {
+      return graph->fanins(graph->indexOf(node)).size();
+    }
+    return Gate::get(node)->inputs().size();
+  }
+
+  ConeViewBuilder::GateId ConeViewBuilder::getFanin(GateId node,
+                                                    size_t i) const {
+    if (graph) {
+      return graph->gateId(*(graph->fanins(graph->indexOf(node)).begin() + i));
+    }
+    return Gate::get(node)->inputs()[i].node();
+  }
+
+  void ConeViewBuilder::mark(GateId node) {
+    if (node >= stamps.size()) {
+      size_t size = std::max<size_t>(node + 1, 2 * stamps.size());
+      stamps.resize(size);
+      positions.resize(size);
+    }
+    stamps[node] = epoch;
+  }
+
+  ConeView ConeViewBuilder::build(GateId root, const Cut &cut) {
+    if (++epoch == 0) {
+      std::fill(stamps.begin(), stamps.end(), 0);
+      epoch = 1;
+    }
+    nodes.clear();
+    leafIndices.clear();
+    fanins.clear();
+    faninOffsets.assign(1, 0);
+
+    // Depth-first search: a node is added after all its fanins.
+    mark(root);
+    stack.emplace_back(root, 0);
+    while (!stack.empty()) {
+      const GateId node = stack.back().first;
+      auto leaf = cut.find(node);
+      const bool isLeaf = leaf != cut.end();
+      const size_t faninsNumber = isLeaf ? 0 : getFaninsNumber(node);
+
+      if (stack.back().second < faninsNumber) {
+        GateId fanin = getFanin(node, stack.back().second++);
+        if (!contains(fanin)) {
+          mark(fanin);
+          stack.emplace_back(fanin, 0);
+        }
+        continue;
+      }
+
+      positions[node] = nodes.size();
+      nodes.push_back(node);
+      leafIndices.push_back(isLeaf ? leaf - cut.begin() : ConeView::NO_LEAF);
+      for (size_t i = 0; i < faninsNumber; ++i) {
+        fanins.push_back(positions[getFanin(node, i)]);
+      }
+      faninOffsets.push_back(fanins.size());
+      stack.pop_back();
+    }
+
+    ConeView view;
+    view.cut = cut;
+    view.nodes = nodes.data();
+    view.leafIndices = leafIndices.data();
+    view.faninOffsets = faninOffsets.data();
+    view.fanins = fanins.data();
+    view.nNodes = nodes.size();
+
+    // Every leaf is reached and is an input of the cone.
+    size_t nLeaves = 0;
+    bool innerLeaf = false;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      if (leafIndices[i] == ConeView::NO_LEAF) {
+        continue;
+      }
+      ++nLeaves;
+      for (size_t j = 0; j < getFaninsNumber(nodes[i]); ++j) {
+        innerLeaf |= contains(getFanin(nodes[i], j));
+      }
+    }
+    view.complete = nLeaves == cut.size() && !innerLeaf;
+    return view;
+  }
+
+} // namespace eda::gate::optimizer
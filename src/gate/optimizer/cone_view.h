@@ -0,0 +1,168 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+#include "gate/optimizer/bgnet.h"
+#include "gate/optimizer/cone_arena.h"
+#include "gate/optimizer/csr_graph.h"
+#include "gate/optimizer/cut_storage.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Read-only view of the cone of a node bounded by a cut.
+  * \ The view refers to the gates of the original net: it holds the cone
+  * \ nodes in topological order (the root is the last one), the positions
+  * \ of the fanins of every node and the indices of the leaves in the cut.
+  * \ The data belong to the ConeViewBuilder that has made the view, so the
+  * \ view is valid until the next build.
+  * \ A cut leaf is an input of the cone even if some of its fanins belong
+  * \ to the cone (such a cone is not complete).
+  */
+  class ConeView {
+
+  public:
+    using GNet = model::GNet;
+    using GateId = GNet::GateId;
+    using Cut = CutStorage::Cut;
+
+    static constexpr uint32_t NO_LEAF = ~uint32_t(0);
+
+    /// Returns the vertex of the cone.
+    GateId getRoot() const { return nodes[nNodes - 1]; }
+
+    /// Returns the cut the cone is bounded by.
+    const Cut &getCut() const { return cut; }
+
+    /// Returns the number of the cone nodes (including the leaves).
+    size_t size() const { return nNodes; }
+
+    /// Returns the node at the given position of the topological order.
+    GateId getNode(size_t position) const { return nodes[position]; }
+
+    /**
+     * Returns the index of the leaf in the cut (the index of the truth table
+     * variable) or NO_LEAF if the node at the given position is not a leaf.
+     */
+    uint32_t getLeafIndex(size_t position) const {
+      return leafIndices[position];
+    }
+
+    /// Returns the index of the gate in the cut or NO_LEAF.
+    uint32_t getLeafIndex(GateId leaf) const;
+
+    /**
+     * Checks that every leaf of the cut is reached from the root
+     * and that no leaf is reached through another one.
+     */
+    bool isComplete() const { return complete; }
+
+    /**
+     * Computes the root value for 64 patterns at once.
+     * @param leafValues Values of the leaves in the cut order.
+     * @param values Buffer for the values of all the nodes.
+     * @param result Value of the root.
+     * @return False if the cone has a gate that cannot be simulated.
+     */
+    bool simulate(const std::vector<uint64_t> &leafValues,
+                  std::vector<uint64_t> &values,
+                  uint64_t &result) const;
+
+    /**
+     * Computes the truth table of the root over the cut leaves
+     * (see cut_truth_table.h for the table format).
+     * @return False if the cut has more than six leaves or the cone has
+     * a gate that cannot be simulated.
+     */
+    bool getTruthTable(uint64_t &table) const;
+
+    /**
+     * Finds the lengths of the shortest and the longest edge paths from
+     * the root to the leaves (like getHeights() does).
+     */
+    void getHeights(int &maxHeight, int &minHeight) const;
+
+    /**
+     * Builds the net of the cone.
+     * @param order Leaves in the order of the input bindings.
+     * @param arena Arena the cone net is created in (may be null).
+     * @return Cone net with input correspondence map.
+     */
+    BoundGNet materialize(const std::vector<GateId> &order,
+                          ConeArena *arena = nullptr) const;
+
+  private:
+    friend class ConeViewBuilder;
+
+    ConeView() = default;
+
+    std::vector<uint64_t> &scratch() const;
+
+    Cut cut;
+    const GateId *nodes = nullptr;
+    const uint32_t *leafIndices = nullptr;
+    const uint32_t *faninOffsets = nullptr;
+    const uint32_t *fanins = nullptr;
+    size_t nNodes = 0;
+    bool complete = false;
+  };
+
+ /**
+  * \brief Makes the cone views reusing its buffers.
+  * \ A builder is not thread-safe, every thread needs its own one.
+  */
+  class ConeViewBuilder {
+
+  public:
+    using GNet = model::GNet;
+    using GateId = GNet::GateId;
+    using Cut = CutStorage::Cut;
+
+    /**
+     * @param graph Snapshot of the net (if null, the fanins are taken
+     * from the gates).
+     */
+    explicit ConeViewBuilder(const CsrGraph *graph = nullptr);
+
+    /**
+     * Finds the cone of the root bounded by the cut.
+     * The previous view of the builder becomes invalid.
+     */
+    ConeView build(GateId root, const Cut &cut);
+
+  private:
+    size_t getFaninsNumber(GateId node) const;
+
+    GateId getFanin(GateId node, size_t i) const;
+
+    bool contains(GateId node) const {
+      return node < stamps.size() && stamps[node] == epoch;
+    }
+
+    void mark(GateId node);
+
+    const CsrGraph *graph;
+
+    // Positions of the nodes indexed by gate identifiers.
+    std::vector<uint32_t> stamps;
+    std::vector<uint32_t> positions;
+    uint32_t epoch = 0;
+
+    std::vector<GateId> nodes;
+    std::vector<uint32_t> leafIndices;
+    std::vector<uint32_t> faninOffsets;
+    std::vector<uint32_t> fanins;
+    std::vector<std::pair<GateId, uint32_t>> stack;
+  };
+
+} // namespace eda::gate::optimizer
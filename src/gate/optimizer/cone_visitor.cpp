@@ -10,9 +10,9 @@
 
 namespace eda::gate::optimizer {
 
-  ConeVisitor::ConeVisitor(const Cut &cut, GateId cutFor) : cut(cut),
-                                                            cutFor(cutFor) {
-    net = new GNet();
+  ConeVisitor::ConeVisitor(const DynamicCut &cut, GateId cutFor,
+                           ConeArena *arena) : cut(cut), cutFor(cutFor) {
+    net = arena ? arena->create() : new GNet();
   }
 
   VisitorFlags ConeVisitor::onNodeBegin(const GateId &node) {
@@ -61,7 +61,7 @@ namespace eda::gate::optimizer {
     return newGates;
   }
 
-  const Cut &ConeVisitor::getResultCutOldGates() {
+  const DynamicCut &ConeVisitor::getResultCutOldGates() {
     return resultCutOldGates;
   }
 
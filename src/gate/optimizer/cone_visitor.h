@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "gate/optimizer/cone_arena.h"
 #include "gate/optimizer/cut_storage.h"
 #include "gate/optimizer/util.h"
 #include "gate/optimizer/visitor.h"
@@ -26,10 +27,14 @@ namespace eda::gate::optimizer {
     using GateSymbol = eda::gate::model::GateSymbol;
 
     /**
-     * @param cut Set of nodes on base of which cone needs to be found.
+     * @param cut Set of nodes on base of which cone needs to be found
+     * (it is copied, so a temporary may be passed).
      * @param cutFor Node for which cone needs to be found.
+     * @param arena Arena the cone net is created in (if null, the net is
+     * allocated on the heap and is owned by the caller).
      */
-    ConeVisitor(const Cut &cut, GateId cutFor);
+    ConeVisitor(const DynamicCut &cut, GateId cutFor,
+                ConeArena *arena = nullptr);
 
     VisitorFlags onNodeBegin(const GateId &) override;
 
@@ -48,14 +53,14 @@ namespace eda::gate::optimizer {
     /**
      * @return Nonredundant cut for the node for which cone was found.
      */
-    const Cut &getResultCutOldGates();
+    const DynamicCut &getResultCutOldGates();
 
   private:
-    const Cut &cut;
+    const DynamicCut cut;
     GateId cutFor;
     // old node - new node.
     MatchMap newGates;
-    Cut resultCutOldGates;
+    DynamicCut resultCutOldGates;
     GNet *net;
 
   };
@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/csr_graph.h"
+
+#include <algorithm>
+
+namespace eda::gate::optimizer {
+
+  using Gate = model::Gate;
+
+  CsrGraph::CsrGraph(const GNet &net) {
+    const auto &gates = net.gates();
+    ids.reserve(gates.size());
+    for (const auto *gate: gates) {
+      ids.push_back(gate->id());
+    }
+    if (ids.empty()) {
+      faninOffsets.push_back(0);
+      fanoutOffsets.push_back(0);
+      return;
+    }
+
+    // Gate identifiers of a net are mostly contiguous.
+    const auto [minIt, maxIt] = std::minmax_element(ids.begin(), ids.end());
+    minId = *minIt;
+    indices.assign(*maxIt - minId + 1, NO_INDEX);
+    for (Index i = 0; i < ids.size(); ++i) {
+      indices[ids[i] - minId] = i;
+    }
+
+    faninOffsets.reserve(ids.size() + 1);
+    fanoutOffsets.reserve(ids.size() + 1);
+    faninOffsets.push_back(0);
+    fanoutOffsets.push_back(0);
+    for (const auto *gate: gates) {
+      for (const auto &input: gate->inputs()) {
+        Index index = indexOf(input.node());
+        if (index != NO_INDEX) {
+          faninIndices.push_back(index);
+        }
+      }
+      faninOffsets.push_back(faninIndices.size());
+
+      for (const auto &link: gate->links()) {
+        Index index = indexOf(link.target);
+        if (index != NO_INDEX) {
+          fanoutIndices.push_back(index);
+        }
+      }
+      fanoutOffsets.push_back(fanoutIndices.size());
+    }
+  }
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Read-only compressed sparse row snapshot of a net.
+  * \ Gates are numbered densely in the order of GNet::gates(). Fanins and
+  * \ fanouts of the gate are stored in two flat arrays as dense indices.
+  * \ Links to the gates out of the net are not stored. The snapshot is not
+  * \ updated when the net is modified.
+  */
+  class CsrGraph {
+
+  public:
+    using GNet = model::GNet;
+    using GateId = GNet::GateId;
+    using Index = uint32_t;
+
+    static constexpr Index NO_INDEX = ~Index(0);
+
+    /// Contiguous range of dense indices.
+    class IndexRange {
+    public:
+      IndexRange(const Index *first, const Index *last) :
+          first(first), last(last) {}
+
+      const Index *begin() const { return first; }
+
+      const Index *end() const { return last; }
+
+      size_t size() const { return last - first; }
+
+      bool empty() const { return first == last; }
+
+    private:
+      const Index *first;
+      const Index *last;
+    };
+
+    explicit CsrGraph(const GNet &net);
+
+    /// Number of gates.
+    size_t size() const { return ids.size(); }
+
+    GateId gateId(Index index) const { return ids[index]; }
+
+    /// Returns the dense index of the gate or NO_INDEX if it is not in the net.
+    Index indexOf(GateId id) const {
+      if (id < minId || id - minId >= indices.size()) {
+        return NO_INDEX;
+      }
+      return indices[id - minId];
+    }
+
+    IndexRange fanins(Index index) const {
+      return {faninIndices.data() + faninOffsets[index],
+              faninIndices.data() + faninOffsets[index + 1]};
+    }
+
+    IndexRange fanouts(Index index) const {
+      return {fanoutIndices.data() + fanoutOffsets[index],
+              fanoutIndices.data() + fanoutOffsets[index + 1]};
+    }
+
+    /**
+     * Returns the fanouts if forward is true and the fanins otherwise
+     * (like getNext() does).
+     */
+    IndexRange next(Index index, bool forward) const {
+      return forward ? fanouts(index) : fanins(index);
+    }
+
+  private:
+    std::vector<GateId> ids;
+    // Dense indices of the gates [minId, minId + indices.size()).
+    std::vector<Index> indices;
+    GateId minId = 0;
+
+    std::vector<Index> faninOffsets;
+    std::vector<Index> faninIndices;
+    std::vector<Index> fanoutOffsets;
+    std::vector<Index> fanoutIndices;
+  };
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,429 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Cut of a fixed capacity that stores its leaves inline.
+  * \ Leaves are kept sorted in ascending order. The 64-bit signature has
+  * \ the bit (id mod 64) set for every leaf. The cut may carry the truth
+  * \ table of the node over its leaves (see cut_truth_table.h).
+  * \ Adding a leaf to a full cut throws std::length_error (also in
+  * \ release builds), since the cuts are built from user input as well.
+  * @tparam K Maximum number of leaves in the cut.
+  */
+  template <size_t K>
+  class StaticCut {
+
+  public:
+    using GateId = model::GNet::GateId;
+    using value_type = GateId;
+    using const_iterator = const GateId *;
+    using iterator = const_iterator;
+
+    static constexpr size_t CAPACITY = K;
+
+    static_assert(K > 0 && K < 256, "Unsupported cut capacity");
+
+    StaticCut() = default;
+
+    template <typename It>
+    StaticCut(It first, It last) {
+      insert(first, last);
+    }
+
+    StaticCut(std::initializer_list<GateId> ids) :
+        StaticCut(ids.begin(), ids.end()) {}
+
+    /**
+     * Returns the signature bit of the given leaf.
+     */
+    static uint64_t signatureOf(GateId id) {
+      return 1ull << (id & 63);
+    }
+
+    size_t size() const { return nLeaves; }
+
+    bool empty() const { return nLeaves == 0; }
+
+    uint64_t signature() const { return sig; }
+
+    const_iterator begin() const { return leaves.data(); }
+
+    const_iterator end() const { return leaves.data() + nLeaves; }
+
+    GateId operator[](size_t i) const { return leaves[i]; }
+
+    /// Checks whether the truth table of the cut is computed.
+    bool hasTruthTable() const { return tableValid; }
+
+    uint64_t truthTable() const { return table; }
+
+    void setTruthTable(uint64_t value) {
+      table = value;
+      tableValid = true;
+    }
+
+    const_iterator find(GateId id) const {
+      if (!(sig & signatureOf(id))) {
+        return end();
+      }
+      const auto *it = std::lower_bound(begin(), end(), id);
+      return (it != end() && *it == id) ? it : end();
+    }
+
+    size_t count(GateId id) const {
+      return find(id) != end() ? 1 : 0;
+    }
+
+    /**
+     * Adds the leaf keeping the leaves sorted.
+     * @return Position of the leaf and flag of successful insertion.
+     * @throws std::length_error if the cut is full.
+     */
+    std::pair<const_iterator, bool> emplace(GateId id) {
+      GateId *last = leaves.data() + nLeaves;
+      GateId *it = std::lower_bound(leaves.data(), last, id);
+      if (it != last && *it == id) {
+        return {it, false};
+      }
+      if (nLeaves == K) {
+        throw std::length_error("Cut capacity exceeded");
+      }
+      std::move_backward(it, last, last + 1);
+      *it = id;
+      ++nLeaves;
+      sig |= signatureOf(id);
+      tableValid = false;
+      return {it, true};
+    }
+
+    std::pair<const_iterator, bool> insert(GateId id) {
+      return emplace(id);
+    }
+
+    template <typename It>
+    void insert(It first, It last) {
+      for (; first != last; ++first) {
+        emplace(*first);
+      }
+    }
+
+    void clear() {
+      nLeaves = 0;
+      sig = 0;
+      tableValid = false;
+    }
+
+    /**
+     * Merges two cuts (the truth table of the result is not computed).
+     * @param lhs First cut.
+     * @param rhs Second cut.
+     * @param limit Maximum number of leaves in the result.
+     * @param result Merged cut (may be one of the arguments).
+     * @return False if the union has more than limit leaves.
+     */
+    static bool merge(const StaticCut &lhs, const StaticCut &rhs,
+                      size_t limit, StaticCut &result) {
+      limit = std::min(limit, K);
+      StaticCut merged;
+      size_t i = 0, j = 0;
+      while (i < lhs.nLeaves || j < rhs.nLeaves) {
+        GateId next;
+        if (j == rhs.nLeaves ||
+            (i < lhs.nLeaves && lhs.leaves[i] < rhs.leaves[j])) {
+          next = lhs.leaves[i++];
+        } else if (i == lhs.nLeaves || rhs.leaves[j] < lhs.leaves[i]) {
+          next = rhs.leaves[j++];
+        } else {
+          next = lhs.leaves[i++];
+          ++j;
+        }
+        if (merged.nLeaves == limit) {
+          return false;
+        }
+        merged.leaves[merged.nLeaves++] = next;
+      }
+      merged.sig = lhs.sig | rhs.sig;
+      result = merged;
+      return true;
+    }
+
+    size_t hash() const {
+      size_t answer = nLeaves;
+      for (GateId id: *this) {
+        answer ^= std::hash<GateId>()(id) + 0x9e3779b9 + (answer << 6) +
+                  (answer >> 2);
+      }
+      return answer;
+    }
+
+    /// Cuts are compared by leaves only.
+    bool operator==(const StaticCut &other) const {
+      return sig == other.sig && nLeaves == other.nLeaves &&
+             std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const StaticCut &other) const {
+      return !(*this == other);
+    }
+
+  private:
+    std::array<GateId, K> leaves{};
+    uint64_t sig = 0;
+    uint64_t table = 0;
+    uint8_t nLeaves = 0;
+    bool tableValid = false;
+  };
+
+ /**
+  * \brief Cut of any number of leaves used as the base of a cone.
+  * \ Leaves are kept sorted in ascending order and have the same signature
+  * \ as in StaticCut. Up to INLINE_SIZE leaves are stored inline, so the
+  * \ cuts found by the enumeration are converted without allocation, the
+  * \ bigger cuts are moved to the heap.
+  */
+  class DynamicCut {
+
+  public:
+    using GateId = model::GNet::GateId;
+    using value_type = GateId;
+    using const_iterator = const GateId *;
+    using iterator = const_iterator;
+
+    static constexpr size_t INLINE_SIZE = 6;
+
+    DynamicCut() = default;
+
+    template <typename It>
+    DynamicCut(It first, It last) {
+      insert(first, last);
+    }
+
+    DynamicCut(std::initializer_list<GateId> ids) :
+        DynamicCut(ids.begin(), ids.end()) {}
+
+    /// Copies the leaves of the static cut (the truth table is dropped).
+    template <size_t K>
+    DynamicCut(const StaticCut<K> &cut) : nLeaves(cut.size()),
+                                          sig(cut.signature()) {
+      if (nLeaves <= INLINE_SIZE) {
+        std::copy(cut.begin(), cut.end(), small.begin());
+      } else {
+        large.assign(cut.begin(), cut.end());
+      }
+    }
+
+    size_t size() const { return nLeaves; }
+
+    bool empty() const { return nLeaves == 0; }
+
+    uint64_t signature() const { return sig; }
+
+    const_iterator begin() const {
+      return large.empty() ? small.data() : large.data();
+    }
+
+    const_iterator end() const { return begin() + nLeaves; }
+
+    GateId operator[](size_t i) const { return begin()[i]; }
+
+    const_iterator find(GateId id) const {
+      if (!(sig & StaticCut<1>::signatureOf(id))) {
+        return end();
+      }
+      const auto *it = std::lower_bound(begin(), end(), id);
+      return (it != end() && *it == id) ? it : end();
+    }
+
+    size_t count(GateId id) const {
+      return find(id) != end() ? 1 : 0;
+    }
+
+    /**
+     * Adds the leaf keeping the leaves sorted.
+     * @return Position of the leaf and flag of successful insertion.
+     */
+    std::pair<const_iterator, bool> emplace(GateId id) {
+      const auto *found = std::lower_bound(begin(), end(), id);
+      const size_t index = found - begin();
+      if (found != end() && *found == id) {
+        return {found, false};
+      }
+      if (large.empty() && nLeaves < INLINE_SIZE) {
+        std::move_backward(small.begin() + index, small.begin() + nLeaves,
+                           small.begin() + nLeaves + 1);
+        small[index] = id;
+      } else {
+        if (large.empty()) {
+          large.assign(small.begin(), small.begin() + nLeaves);
+        }
+        large.insert(large.begin() + index, id);
+      }
+      ++nLeaves;
+      sig |= StaticCut<1>::signatureOf(id);
+      return {begin() + index, true};
+    }
+
+    std::pair<const_iterator, bool> insert(GateId id) {
+      return emplace(id);
+    }
+
+    template <typename It>
+    void insert(It first, It last) {
+      for (; first != last; ++first) {
+        emplace(*first);
+      }
+    }
+
+    void clear() {
+      large.clear();
+      nLeaves = 0;
+      sig = 0;
+    }
+
+    size_t hash() const {
+      size_t answer = nLeaves;
+      for (GateId id: *this) {
+        answer ^= std::hash<GateId>()(id) + 0x9e3779b9 + (answer << 6) +
+                  (answer >> 2);
+      }
+      return answer;
+    }
+
+    bool operator==(const DynamicCut &other) const {
+      return sig == other.sig && nLeaves == other.nLeaves &&
+             std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const DynamicCut &other) const {
+      return !(*this == other);
+    }
+
+  private:
+    std::array<GateId, INLINE_SIZE> small{};
+    std::vector<GateId> large;
+    size_t nLeaves = 0;
+    uint64_t sig = 0;
+  };
+
+ /**
+  * \brief Set of cuts of a single node stored contiguously.
+  * \ Cuts are kept in the insertion order, so iteration is deterministic.
+  * \ Erasing moves the last cut to the place of the erased one.
+  */
+  template <typename CutT>
+  class StaticCutSet {
+
+    using Storage = std::vector<CutT>;
+
+  public:
+    using value_type = CutT;
+    using const_iterator = typename Storage::const_iterator;
+    using iterator = const_iterator;
+
+    size_t size() const { return cuts.size(); }
+
+    bool empty() const { return cuts.empty(); }
+
+    const_iterator begin() const { return cuts.begin(); }
+
+    const_iterator end() const { return cuts.end(); }
+
+    const CutT &operator[](size_t i) const { return cuts[i]; }
+
+    void reserve(size_t n) { cuts.reserve(n); }
+
+    void clear() { cuts.clear(); }
+
+    const_iterator find(const CutT &cut) const {
+      return std::find(cuts.begin(), cuts.end(), cut);
+    }
+
+    size_t count(const CutT &cut) const {
+      return find(cut) != end() ? 1 : 0;
+    }
+
+    std::pair<const_iterator, bool> emplace(const CutT &cut) {
+      auto found = find(cut);
+      if (found != end()) {
+        return {found, false};
+      }
+      cuts.push_back(cut);
+      return {std::prev(cuts.end()), true};
+    }
+
+    std::pair<const_iterator, bool> insert(const CutT &cut) {
+      return emplace(cut);
+    }
+
+    /**
+     * Adds the cut without checking that it is not in the set yet.
+     */
+    void append(const CutT &cut) {
+      cuts.push_back(cut);
+    }
+
+    /**
+     * Erases the cuts satisfying the predicate keeping the order of others.
+     * The predicate is applied to the cuts in order, once per cut.
+     * @return Number of erased cuts.
+     */
+    template <typename Pred>
+    size_t eraseIf(Pred pred) {
+      size_t kept = 0;
+      for (size_t i = 0; i < cuts.size(); ++i) {
+        if (pred(static_cast<const CutT &>(cuts[i]))) {
+          continue;
+        }
+        if (kept != i) {
+          cuts[kept] = cuts[i];
+        }
+        ++kept;
+      }
+      size_t erased = cuts.size() - kept;
+      cuts.resize(kept);
+      return erased;
+    }
+
+    /**
+     * Erases the cut, its place is taken by the last cut of the set.
+     * @return Iterator to the cut that took the place of the erased one.
+     */
+    const_iterator erase(const_iterator pos) {
+      auto index = pos - cuts.begin();
+      if (pos + 1 != cuts.end()) {
+        cuts[index] = cuts.back();
+      }
+      cuts.pop_back();
+      return cuts.begin() + index;
+    }
+
+    bool operator==(const StaticCutSet &other) const {
+      return cuts == other.cuts;
+    }
+
+  private:
+    Storage cuts;
+  };
+
+} // namespace eda::gate::optimizer
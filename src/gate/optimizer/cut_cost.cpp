@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/cut_cost.h"
+
+#include <algorithm>
+
+namespace eda::gate::optimizer {
+
+  using Gate = model::Gate;
+
+  static double getFanout(CutCost::GateId gateId) {
+    return std::max<size_t>(1, Gate::get(gateId)->links().size());
+  }
+
+  double LeafCountCost::cost(GateId, const Cut &cut) const {
+    return cut.size();
+  }
+
+  double FanoutWeightedSizeCost::cost(GateId, const Cut &cut) const {
+    double result = 0;
+    for (GateId leaf: cut) {
+      result += 1.0 / getFanout(leaf);
+    }
+    return result;
+  }
+
+  void PropagatedCutCost::prepare(const GNet &net) {
+    values.clear();
+    values.reserve(net.nGates());
+    // All the entries are created in advance, so the values of distinct
+    // nodes can be updated concurrently.
+    for (const auto *gate: net.gates()) {
+      values.emplace(gate->id(), 0.0);
+    }
+  }
+
+  void PropagatedCutCost::onCutsSelected(GateId node, const Cuts &cuts) {
+    // The first cut is the trivial one.
+    values[node] = cuts.size() > 1 ? cost(node, cuts[1]) : 0.0;
+  }
+
+  double PropagatedCutCost::getValue(GateId node) const {
+    auto found = values.find(node);
+    return found != values.end() ? found->second : 0.0;
+  }
+
+  double DepthCost::cost(GateId, const Cut &cut) const {
+    double depth = 0;
+    for (GateId leaf: cut) {
+      depth = std::max(depth, getValue(leaf));
+    }
+    return depth + 1;
+  }
+
+  double AreaFlowCost::cost(GateId, const Cut &cut) const {
+    double flow = 1;
+    for (GateId leaf: cut) {
+      flow += getValue(leaf) / getFanout(leaf);
+    }
+    return flow;
+  }
+
+} // namespace eda::gate::optimizer
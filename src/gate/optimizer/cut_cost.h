@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+#include "gate/optimizer/cut_storage.h"
+
+#include <unordered_map>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Interface of a cost used to rank the cuts of a node.
+  * \ The lower the cost, the better the cut.
+  */
+  class CutCost {
+
+  public:
+    using GNet = model::GNet;
+    using GateId = GNet::GateId;
+    using Cut = CutStorage::Cut;
+    using Cuts = CutStorage::Cuts;
+
+    virtual ~CutCost() = default;
+
+    /**
+     * Prepares the cost for cut enumeration in the net.
+     */
+    virtual void prepare(const GNet &) {}
+
+    /**
+     * Returns the cost of the nontrivial cut of the node.
+     * Fanin nodes of the cut leaves are handled before the node.
+     */
+    virtual double cost(GateId node, const Cut &cut) const = 0;
+
+    /**
+     * Notifies that the cuts of the node are selected.
+     * @param node Node which cuts are selected.
+     * @param cuts Selected cuts: the trivial cut, then others best first.
+     */
+    virtual void onCutsSelected(GateId, const Cuts &) {}
+  };
+
+ /**
+  * \brief Ranks cuts by the number of leaves.
+  */
+  class LeafCountCost : public CutCost {
+
+  public:
+    double cost(GateId node, const Cut &cut) const override;
+  };
+
+ /**
+  * \brief Ranks cuts by the number of leaves weighted by their fanout.
+  * \ Leaves with large fanout are shared with other cones, so they are
+  * \ cheaper than the ones used by the cone only.
+  */
+  class FanoutWeightedSizeCost : public CutCost {
+
+  public:
+    double cost(GateId node, const Cut &cut) const override;
+  };
+
+ /**
+  * \brief Base class for costs propagated from the leaves to the node.
+  * \ The value of a node is the cost of its best nontrivial cut
+  * \ (zero for the nodes having the trivial cut only).
+  */
+  class PropagatedCutCost : public CutCost {
+
+  public:
+    void prepare(const GNet &net) override;
+
+    void onCutsSelected(GateId node, const Cuts &cuts) override;
+
+    /**
+     * Returns the value of the handled node.
+     */
+    double getValue(GateId node) const;
+
+  private:
+    std::unordered_map<GateId, double> values;
+  };
+
+ /**
+  * \brief Ranks cuts by the depth of the mapped node: one plus the
+  * \ maximum depth of the leaves.
+  */
+  class DepthCost : public PropagatedCutCost {
+
+  public:
+    double cost(GateId node, const Cut &cut) const override;
+  };
+
+ /**
+  * \brief Ranks cuts by the area flow: one plus the sum of the leaves
+  * \ area flows, each divided by the fanout of the leaf.
+  */
+  class AreaFlowCost : public PropagatedCutCost {
+
+  public:
+    double cost(GateId node, const Cut &cut) const override;
+  };
+
+} // namespace eda::gate::optimizer
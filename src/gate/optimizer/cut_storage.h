@@ -9,6 +9,7 @@
 #pragma once
 
 #include "gate/model/gnet.h"
+#include "gate/optimizer/cut.h"
 
 #include <unordered_map>
 
@@ -20,21 +21,19 @@ namespace eda::gate::optimizer {
   struct CutStorage {
     using GNet = model::GNet;
     using GateId = GNet::GateId;
-    using Cut = std::unordered_set<GateId>;
+
+    /// Maximum number of leaves in a stored cut.
+    static constexpr size_t MAX_CUT_SIZE = 6;
+
+    using Cut = StaticCut<MAX_CUT_SIZE>;
 
     struct HashFunction {
       size_t operator()(const Cut &cut) const {
-        std::hash<int> hasher;
-        size_t answer = 0;
-
-        for (int i: cut) {
-          answer ^= hasher(i) + 0x9e3779b9 + (answer << 6) + (answer >> 2);
-        }
-        return answer;
+        return cut.hash();
       }
     };
 
-    using Cuts = std::unordered_set<Cut, HashFunction>;
+    using Cuts = StaticCutSet<Cut>;
 
     std::unordered_map<GateId, Cuts> cuts;
   };
@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/cut_truth_table.h"
+
+namespace eda::gate::optimizer {
+
+  using GateSymbol = model::GateSymbol;
+
+  // Masks selecting the minterms where the variable is one.
+  static constexpr uint64_t varMasks[6] = {
+      0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+      0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull};
+
+  // Masks for swapping the variables i and i + 1: kept bits, bits moved
+  // up and bits moved down.
+  static constexpr uint64_t swapMasks[5][3] = {
+      {0x9999999999999999ull, 0x2222222222222222ull, 0x4444444444444444ull},
+      {0xC3C3C3C3C3C3C3C3ull, 0x0C0C0C0C0C0C0C0Cull, 0x3030303030303030ull},
+      {0xF00FF00FF00FF00Full, 0x00F000F000F000F0ull, 0x0F000F000F000F00ull},
+      {0xFF0000FFFF0000FFull, 0x0000FF000000FF00ull, 0x00FF000000FF0000ull},
+      {0xFFFF00000000FFFFull, 0x00000000FFFF0000ull, 0x0000FFFF00000000ull}};
+
+  static uint64_t swapAdjacent(uint64_t table, size_t var) {
+    const auto &masks = swapMasks[var];
+    const unsigned shift = 1u << var;
+    return (table & masks[0]) | ((table & masks[1]) << shift) |
+           ((table & masks[2]) >> shift);
+  }
+
+  uint64_t expandCutTable(uint64_t table,
+                          const CutStorage::Cut &from,
+                          const CutStorage::Cut &to) {
+    if (from.size() == to.size()) {
+      return table;
+    }
+
+    // Leaves of both cuts are sorted, so the positions grow: variables are
+    // moved up starting from the last one, over the unused ones.
+    size_t j = to.size();
+    for (size_t i = from.size(); i-- > 0;) {
+      while (to[--j] != from[i]) {}
+      for (size_t k = i; k < j; ++k) {
+        table = swapAdjacent(table, k);
+      }
+    }
+    return table;
+  }
+
+  bool evaluateCutTable(GateSymbol func,
+                        const std::vector<uint64_t> &inputs,
+                        uint64_t &result) {
+    if (inputs.empty()) {
+      return false;
+    }
+
+    switch (func) {
+      case GateSymbol::NOP:
+      case GateSymbol::OUT:
+        if (inputs.size() != 1) {
+          return false;
+        }
+        result = inputs[0];
+        return true;
+      case GateSymbol::NOT:
+        if (inputs.size() != 1) {
+          return false;
+        }
+        result = ~inputs[0];
+        return true;
+      case GateSymbol::AND:
+      case GateSymbol::NAND:
+        result = ~0ull;
+        for (uint64_t input: inputs) {
+          result &= input;
+        }
+        break;
+      case GateSymbol::OR:
+      case GateSymbol::NOR:
+        result = 0;
+        for (uint64_t input: inputs) {
+          result |= input;
+        }
+        break;
+      case GateSymbol::XOR:
+      case GateSymbol::XNOR:
+        result = 0;
+        for (uint64_t input: inputs) {
+          result ^= input;
+        }
+        break;
+      case GateSymbol::MAJ:
+        if (inputs.size() != 3) {
+          return false;
+        }
+        result = (inputs[0] & inputs[1]) | (inputs[0] & inputs[2]) |
+                 (inputs[1] & inputs[2]);
+        return true;
+      default:
+        return false;
+    }
+
+    if (func == GateSymbol::NAND || func == GateSymbol::NOR ||
+        func == GateSymbol::XNOR) {
+      result = ~result;
+    }
+    return true;
+  }
+
+  bool dependsOnVariable(uint64_t table, size_t var) {
+    const unsigned shift = 1u << var;
+    return ((table & varMasks[var]) >> shift) != (table & ~varMasks[var]);
+  }
+
+} // namespace eda::gate::optimizer
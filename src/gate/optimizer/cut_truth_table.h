@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+#include "gate/optimizer/cut_storage.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * \brief Truth tables of cuts with up to six leaves.
+ * \ A table is a 64-bit word: the bit m holds the function value on the
+ * \ minterm m, where the bit i of m is the value of the i-th (sorted) leaf.
+ * \ Tables of functions of fewer variables are replicated over the word.
+ */
+namespace eda::gate::optimizer {
+
+  /// Table of the first variable (the table of a trivial cut).
+  constexpr uint64_t CUT_VAR_TABLE = 0xAAAAAAAAAAAAAAAAull;
+
+  /**
+   * \brief Expresses the table over the leaves of a bigger cut.
+   * @param table Table over the leaves of the smaller cut.
+   * @param from Smaller cut.
+   * @param to Cut containing all the leaves of the smaller one.
+   * @return Table over the leaves of the bigger cut.
+   */
+  uint64_t expandCutTable(uint64_t table,
+                          const CutStorage::Cut &from,
+                          const CutStorage::Cut &to);
+
+  /**
+   * \brief Computes the table of a gate from the tables of its inputs.
+   * @param func Gate function.
+   * @param inputs Tables of the gate inputs.
+   * @param result Table of the gate.
+   * @return False if the gate function is not supported.
+   */
+  bool evaluateCutTable(model::GateSymbol func,
+                        const std::vector<uint64_t> &inputs,
+                        uint64_t &result);
+
+  /**
+   * \brief Checks whether the function depends on the variable.
+   */
+  bool dependsOnVariable(uint64_t table, size_t var);
+
+} // namespace eda::gate::optimizer
@@ -6,8 +6,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "gate/optimizer/cut_truth_table.h"
 #include "gate/optimizer/cuts_finder_visitor.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace eda::gate::optimizer {
 
   using Gate = eda::gate::model::Gate;
@@ -18,7 +22,18 @@ namespace eda::gate::optimizer {
   CutsFindVisitor::CutsFindVisitor(unsigned int cutSize, CutStorage *cutStorage,
                                    unsigned int maxCutsNumber, bool old) :
       cutSize(cutSize), maxCutNum(maxCutsNumber),
-      cutStorage(cutStorage), old(old) {}
+      cutStorage(cutStorage), old(old) {
+    // The stored cuts cannot hold more leaves (in all the build types).
+    if (cutSize > CutStorage::MAX_CUT_SIZE) {
+      throw std::invalid_argument("Too big cut size");
+    }
+  }
+
+  CutsFindVisitor::CutsFindVisitor(unsigned int cutSize, CutStorage *cutStorage,
+                                   unsigned int maxCutsNumber, CutCost *cost) :
+      CutsFindVisitor(cutSize, cutStorage, maxCutsNumber, false) {
+    this->cost = cost;
+  }
 
 
   VisitorFlags CutsFindVisitor::onNodeBegin(const GateId &vertex) {
@@ -65,9 +80,8 @@ namespace eda::gate::optimizer {
       Cut collected;
 
       for (auto &it: ptrs) {
-        collected.insert((*it).begin(), (*it).end());
-        if (collected.size() > cutSize) {
-          collected = Cut();
+        if (!Cut::merge(collected, *it, cutSize, collected)) {
+          collected.clear();
           break;
         }
       }
@@ -104,42 +118,194 @@ namespace eda::gate::optimizer {
     if (gate->func() == model::GateSymbol::NOT) {
       return CONTINUE;
     }
-    Cuts *cuts = &cutStorage->cuts[vertex];
 
+    std::vector<const Cuts *> inputCuts;
+    if (collectInputCuts(vertex, inputCuts)) {
+      findNodeCuts(vertex, inputCuts, cutStorage->cuts[vertex]);
+      return CONTINUE;
+    }
+
+    // Some fanins are not handled yet: the cuts of the unhandled part
+    // of the cone are found in topological order.
+    enumerate(getWorklist(vertex));
+    return CONTINUE;
+  }
+
+  void CutsFindVisitor::enumerate(const std::vector<GateId> &order) {
+    cutStorage->cuts.reserve(cutStorage->cuts.size() + order.size());
+
+    std::vector<const Cuts *> inputCuts;
+    for (const GateId &node: order) {
+      if (Gate::get(node)->func() == model::GateSymbol::NOT) {
+        continue;
+      }
+      if (!collectInputCuts(node, inputCuts)) {
+        // The order is not topological for the node.
+        enumerate(getWorklist(node));
+        continue;
+      }
+      findNodeCuts(node, inputCuts, cutStorage->cuts[node]);
+    }
+  }
+
+  void CutsFindVisitor::update(const NetChanges &changes,
+                               Levelization *levelization) {
+    if (levelization) {
+      levelization->invalidate();
+    }
+
+    std::unordered_set<GateId> removed(changes.removed.begin(),
+                                       changes.removed.end());
+    for (const GateId &gate: changes.removed) {
+      cutStorage->cuts.erase(gate);
+    }
+
+    // Collecting the transitive fanout of the modified gates.
+    std::unordered_map<GateId, size_t> affected;
+    std::vector<GateId> queue;
+    for (const GateId &gate: changes.modified) {
+      if (!removed.count(gate) && affected.emplace(gate, 0).second) {
+        queue.push_back(gate);
+      }
+    }
+    for (size_t i = 0; i < queue.size(); ++i) {
+      for (const auto &out: Gate::get(queue[i])->links()) {
+        if (affected.emplace(out.target, 0).second) {
+          queue.push_back(out.target);
+        }
+      }
+    }
+
+    // Ordering the affected gates topologically: a gate goes after all
+    // its affected fanins.
+    for (auto &[gate, fanins]: affected) {
+      for (const auto &input: Gate::get(gate)->inputs()) {
+        fanins += affected.count(input.node());
+      }
+    }
+    std::vector<GateId> order;
+    order.reserve(affected.size());
+    for (const auto &[gate, fanins]: affected) {
+      if (fanins == 0) {
+        order.push_back(gate);
+      }
+    }
+    for (size_t i = 0; i < order.size(); ++i) {
+      for (const auto &out: Gate::get(order[i])->links()) {
+        auto found = affected.find(out.target);
+        if (found != affected.end() && --found->second == 0) {
+          order.push_back(out.target);
+        }
+      }
+    }
+
+    for (const GateId &gate: order) {
+      cutStorage->cuts.erase(gate);
+    }
+    enumerate(order);
+  }
+
+  bool CutsFindVisitor::collectInputCuts(const GateId &vertex,
+                                         std::vector<const Cuts *> &inputCuts) {
+    const auto &inputs = Gate::get(vertex)->inputs();
+    inputCuts.clear();
+    inputCuts.reserve(inputs.size());
+
+    for (const auto &input: inputs) {
+      GateId gateIdInput = getCutInput(input.node());
+      auto found = cutStorage->cuts.find(gateIdInput);
+      if (found != cutStorage->cuts.end() && !found->second.empty()) {
+        inputCuts.push_back(&found->second);
+      } else if (Gate::get(gateIdInput)->func() == model::GateSymbol::NOT) {
+        // Chains of NOT gates have no cuts.
+        inputCuts.push_back(&cutStorage->cuts[gateIdInput]);
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::vector<CutsFindVisitor::GateId>
+  CutsFindVisitor::getWorklist(const GateId &vertex) const {
+    // Iterative DFS: a node is added after all its unhandled fanins.
+    std::vector<GateId> worklist;
+    std::vector<std::pair<GateId, size_t>> stack;
+    std::unordered_set<GateId> visited;
+
+    stack.emplace_back(vertex, 0);
+    visited.emplace(vertex);
+    while (!stack.empty()) {
+      GateId node = stack.back().first;
+      size_t index = stack.back().second++;
+
+      const auto &inputs = Gate::get(node)->inputs();
+      if (index == inputs.size()) {
+        worklist.push_back(node);
+        stack.pop_back();
+        continue;
+      }
+
+      GateId gateIdInput = getCutInput(inputs[index].node());
+      if (Gate::get(gateIdInput)->func() == model::GateSymbol::NOT ||
+          !visited.emplace(gateIdInput).second) {
+        continue;
+      }
+      auto found = cutStorage->cuts.find(gateIdInput);
+      if (found == cutStorage->cuts.end() || found->second.empty()) {
+        stack.emplace_back(gateIdInput, 0);
+      }
+    }
+    return worklist;
+  }
+
+  CutsFindVisitor::GateId CutsFindVisitor::getCutInput(const GateId &input) {
+    // NOT gates have no cuts: the cuts of their inputs are used.
+    Gate *gateInput = Gate::get(input);
+    if (gateInput->func() == model::GateSymbol::NOT) {
+      return gateInput->inputs().begin()->node();
+    }
+    return input;
+  }
+
+  void CutsFindVisitor::findNodeCuts(const GateId &vertex,
+                                     const std::vector<const Cuts *> &inputCuts,
+                                     Cuts &cuts) const {
     // Adding trivial cut.
+    // The constants are simulated as constants (as in ConeView).
+    const auto func = Gate::get(vertex)->func();
     Cut self;
     self.emplace(vertex);
-    cuts->emplace(self);
+    if (func == model::GateSymbol::ZERO || func == model::GateSymbol::ONE) {
+      self.setTruthTable(func == model::GateSymbol::ZERO ? 0 : ~0ull);
+    } else {
+      self.setTruthTable(CUT_VAR_TABLE);
+    }
+    cuts.emplace(self);
 
     std::vector<CutIt> ptrs;
-    std::vector<Cuts *> inputCuts;
+    std::vector<uint64_t> tables;
     size_t i = 0;
 
-    ptrs.reserve(gate->inputs().size());
-    inputCuts.reserve(gate->inputs().size());
-
     // Initializing ptrs to cuts of input.
-    for (auto input: gate->inputs()) {
-      GateId gateIdInput = input.node();
-      Gate *gateInput = Gate::get(input.node());
-      if (gateInput->func() == model::GateSymbol::NOT) {
-        gateIdInput = gateInput->inputs().begin()->node();
-      }
-      if (cutStorage->cuts[gateIdInput].empty()) {
-          onNodeBeginNew(gateIdInput);
-      }
-      inputCuts.push_back(&cutStorage->cuts[gateIdInput]);
-      ptrs.push_back(inputCuts.back()->begin());
+    ptrs.reserve(inputCuts.size());
+    for (const auto *input: inputCuts) {
+      ptrs.push_back(input->begin());
     }
 
-    while (true) {
+    // A fanin without cuts (a chain of NOT gates) gives no combinations.
+    bool noCombinations = std::any_of(inputCuts.begin(), inputCuts.end(),
+                                      [](const Cuts *input) {
+                                        return input->empty();
+                                      });
+
+    while (!noCombinations) {
       // Fix cut.
       Cut collected;
 
       for (auto &it: ptrs) {
-        collected.insert((*it).begin(), (*it).end());
-        if (collected.size() > cutSize) {
-          collected = Cut();
+        if (!Cut::merge(collected, *it, cutSize, collected)) {
+          collected.clear();
           break;
         }
       }
@@ -149,33 +315,34 @@ namespace eda::gate::optimizer {
       bool incrementAll = false;
 
       if (!collected.empty()) {
-        std::vector<Cuts::iterator> toRemove;
-        for (auto it = cuts->begin(); it != cuts->end(); ++it) {
-          const Cut &addedCut = *it;
+        // Stored cuts never dominate each other, so a dominated candidate
+        // cannot dominate a stored cut: nothing is erased before the
+        // candidate is found to be dominated.
+        auto isSubset = [this](const Cut &smaller, const Cut &bigger) {
+          return signatureFilter
+              ? isSubsetOf(smaller, bigger)
+              : std::includes(bigger.begin(), bigger.end(),
+                              smaller.begin(), smaller.end());
+        };
+        cuts.eraseIf([&](const Cut &addedCut) {
+          if (biggerCut) {
+            return false;
+          }
           if (addedCut.size() > collected.size()) {
-            if (isSubsetOf(collected, addedCut)) {
-              toRemove.emplace_back(it);
-            }
-          } else {
-            if (isSubsetOf(addedCut, collected)) {
-              biggerCut = true;
-              break;
-            }
+            return isSubset(collected, addedCut);
           }
-        }
-        // remove all and add this
-        // if it's dominator (size==0 and smallerCut = true) - everything all cuts have to be incremented (think of how to do that)
-        // don't add this because it's a bigger cut
+          biggerCut = isSubset(addedCut, collected);
+          return false;
+        });
 
         if (!biggerCut) {
-          for (const auto &it: toRemove) {
-            cuts->erase(it);
+          // Emplacing the cut (equal cuts are dominated, so it is unique).
+          if (truthTables) {
+            setTruthTable(vertex, ptrs, tables, collected);
           }
-
-          // Emplacing the cut.
-          cuts->emplace(collected);
-          if (maxCutNum != ALL_CUTS && cuts->size() > maxCutNum) {
-            return CONTINUE;
+          cuts.append(collected);
+          if (!cost && maxCutNum != ALL_CUTS && cuts.size() > maxCutNum) {
+            return;
           }
 
           incrementAll = collected.size() == 1;
@@ -213,7 +380,76 @@ namespace eda::gate::optimizer {
         }
       }
     }
-    return CONTINUE;
+
+    if (cost) {
+      selectPriorityCuts(vertex, cuts);
+    }
+  }
+
+  void CutsFindVisitor::setTruthTable(const GateId &vertex,
+                                      const std::vector<CutIt> &ptrs,
+                                      std::vector<uint64_t> &tables,
+                                      Cut &cut) const {
+    const Gate *gate = Gate::get(vertex);
+    tables.clear();
+    for (size_t j = 0; j < ptrs.size(); ++j) {
+      const Cut &inputCut = *ptrs[j];
+      if (!inputCut.hasTruthTable()) {
+        return;
+      }
+      uint64_t table = expandCutTable(inputCut.truthTable(), inputCut, cut);
+      // NOT gates have no cuts, the cut of the NOT input is inverted.
+      if (gate->inputs()[j].node() != getCutInput(gate->inputs()[j].node())) {
+        table = ~table;
+      }
+      tables.push_back(table);
+    }
+
+    uint64_t table;
+    if (evaluateCutTable(gate->func(), tables, table)) {
+      cut.setTruthTable(table);
+    }
+  }
+
+  void CutsFindVisitor::selectPriorityCuts(const GateId &vertex,
+                                           Cuts &cuts) const {
+    // The trivial cut goes first and is always kept.
+    std::vector<std::pair<double, Cut>> ranked;
+    ranked.reserve(cuts.size());
+    for (auto it = std::next(cuts.begin()); it != cuts.end(); ++it) {
+      ranked.emplace_back(cost->cost(vertex, *it), *it);
+    }
+
+    size_t kept = ranked.size();
+    if (maxCutNum != ALL_CUTS) {
+      kept = std::min<size_t>(kept, maxCutNum);
+    }
+
+    // Ties are broken by the cut size and the leaves to be deterministic.
+    auto less = [](const auto &lhs, const auto &rhs) {
+      if (lhs.first != rhs.first) {
+        return lhs.first < rhs.first;
+      }
+      if (lhs.second.size() != rhs.second.size()) {
+        return lhs.second.size() < rhs.second.size();
+      }
+      return std::lexicographical_compare(lhs.second.begin(),
+                                          lhs.second.end(),
+                                          rhs.second.begin(),
+                                          rhs.second.end());
+    };
+    std::partial_sort(ranked.begin(), ranked.begin() + kept, ranked.end(),
+                      less);
+
+    Cut self = *cuts.begin();
+    cuts.clear();
+    cuts.reserve(kept + 1);
+    cuts.append(self);
+    for (size_t j = 0; j < kept; ++j) {
+      cuts.append(ranked[j].second);
+    }
+
+    cost->onCutsSelected(vertex, cuts);
   }
 
   VisitorFlags CutsFindVisitor::onNodeEnd(const GateId &) {
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "gate/optimizer/cut_cost.h"
 #include "gate/optimizer/cut_storage.h"
 #include "gate/optimizer/util.h"
 #include "gate/optimizer/visitor.h"
@@ -23,26 +24,105 @@ namespace eda::gate::optimizer {
     unsigned int maxCutNum;
     CutStorage *cutStorage;
     bool old;
+    CutCost *cost = nullptr;
+    bool truthTables = false;
+    bool signatureFilter = true;
   public:
 
     constexpr static unsigned int ALL_CUTS = 0;
 
     /**
-     * @param cutSize Max number of nodes in a cut.
+     * @param cutSize Max number of nodes in a cut
+     * (not greater than CutStorage::MAX_CUT_SIZE).
      * @param cutStorage Struct where cuts are stored.
      * @param maxCutsNumber Maximum number of cuts for a single node.
      * To avoid restriction CutsFindVisitor::ALL_CUTS can be used.
+     * @throws std::invalid_argument if the cut size is too big.
      */
     CutsFindVisitor(unsigned int cutSize, CutStorage *cutStorage,
                     unsigned int maxCutsNumber = ALL_CUTS, bool old = false);
 
+    /**
+     * Creates the visitor that keeps the best cuts for each node.
+     * All combinations of the fanin cuts are merged, then the trivial cut
+     * and maxCutsNumber cuts of the lowest cost are kept.
+     * @param cutSize Max number of nodes in a cut
+     * (not greater than CutStorage::MAX_CUT_SIZE).
+     * @param cutStorage Struct where cuts are stored.
+     * @param maxCutsNumber Number of cuts kept for a single node
+     * besides the trivial one.
+     * To keep all the cuts CutsFindVisitor::ALL_CUTS can be used.
+     * @param cost Cost the cuts are ranked by (nullptr to find the cuts
+     * like the other constructor does).
+     */
+    CutsFindVisitor(unsigned int cutSize, CutStorage *cutStorage,
+                    unsigned int maxCutsNumber, CutCost *cost);
+
+    /**
+     * Enables computing the truth tables of the found cuts.
+     * The table of a cut is built from the tables of the merged fanin
+     * cuts, it is not computed for the cones with unsupported gates.
+     */
+    void setTruthTables(bool enabled) { truthTables = enabled; }
+
+    /**
+     * Enables rejecting the dominance checks by the leaf signatures
+     * (enabled by default). The found cuts do not depend on it.
+     */
+    void setSignatureFilter(bool enabled) { signatureFilter = enabled; }
+
     VisitorFlags onNodeBegin(const GateId &) override;
 
     VisitorFlags onNodeEnd(const GateId &) override;
 
+    /**
+     * Finds the cuts of the nodes in the given order without recursion.
+     * Nodes which fanins are not handled before them are supported,
+     * but a topological order is the fastest one.
+     * @param order Nodes to find the cuts of.
+     */
+    void enumerate(const std::vector<GateId> &order);
+
+    /**
+     * Updates the found cuts after the net has been edited.
+     * The cuts of the modified gates and their transitive fanout are found
+     * again, the cuts of the other nodes are kept untouched.
+     * @param changes Gates modified and erased by the edit.
+     * @param levelization If not null, the cached order of the edited
+     * net, it is invalidated.
+     */
+    void update(const NetChanges &changes,
+                Levelization *levelization = nullptr);
+
+    /**
+     * Finds the cuts of the node from the cuts of its fanins.
+     * Neither the visitor nor the storage is modified, so the method
+     * may be called concurrently for the nodes which fanin cuts are found.
+     * @param vertex Node which cuts are found.
+     * @param inputCuts Cuts of the node fanins (NOT gates are passed).
+     * @param cuts Set where the node cuts are added.
+     */
+    void findNodeCuts(const GateId &vertex,
+                      const std::vector<const CutStorage::Cuts *> &inputCuts,
+                      CutStorage::Cuts &cuts) const;
+
   private:
     VisitorFlags onNodeBeginOld(const GateId &);
 
     VisitorFlags onNodeBeginNew(const GateId &);
+
+    bool collectInputCuts(const GateId &vertex,
+                          std::vector<const CutStorage::Cuts *> &inputCuts);
+
+    std::vector<GateId> getWorklist(const GateId &vertex) const;
+
+    static GateId getCutInput(const GateId &input);
+
+    void setTruthTable(const GateId &vertex,
+                       const std::vector<CutStorage::Cuts::iterator> &ptrs,
+                       std::vector<uint64_t> &tables,
+                       CutStorage::Cut &cut) const;
+
+    void selectPriorityCuts(const GateId &, CutStorage::Cuts &cuts) const;
   };
 } // namespace eda::gate::optimizer
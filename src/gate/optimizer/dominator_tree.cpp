@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/dominator_tree.h"
+
+#include <algorithm>
+
+namespace eda::gate::optimizer {
+
+  using Gate = model::Gate;
+
+  DominatorTree::DominatorTree(const std::vector<GateId> &topoOrder) :
+      order(topoOrder) {
+    build();
+  }
+
+  DominatorTree::DominatorTree(Levelization &levelization) :
+      order(levelization.getOrder()) {
+    build();
+  }
+
+  std::vector<DominatorTree::GateId>
+  DominatorTree::getDominators(GateId node) const {
+    std::vector<GateId> dominators;
+    for (Index i = indexOf(node); i != ROOT; i = idoms[i]) {
+      dominators.push_back(order[i - 1]);
+    }
+    return dominators;
+  }
+
+  DominatorTree::Index DominatorTree::intersect(Index lhs, Index rhs) const {
+    // Dominators precede the nodes in the order.
+    while (lhs != rhs) {
+      while (lhs > rhs) {
+        lhs = idoms[lhs];
+      }
+      while (rhs > lhs) {
+        rhs = idoms[rhs];
+      }
+    }
+    return lhs;
+  }
+
+  void DominatorTree::build() {
+    const Index size = order.size() + 1;
+    const auto [minIt, maxIt] = std::minmax_element(order.begin(), order.end());
+    minId = order.empty() ? 0 : *minIt;
+    indices.assign(order.empty() ? 0 : *maxIt - minId + 1, NO_INDEX);
+    for (Index i = 1; i < size; ++i) {
+      indices[order[i - 1] - minId] = i;
+    }
+
+    idoms.assign(size, ROOT);
+    for (Index i = 1; i < size; ++i) {
+      const auto &inputs = Gate::get(order[i - 1])->inputs();
+      Index idom = NO_INDEX;
+      for (const auto &input: inputs) {
+        const Index fanin = indexOf(input.node());
+        if (fanin == NO_INDEX || fanin >= i) {
+          idom = ROOT;
+          break;
+        }
+        idom = idom == NO_INDEX ? fanin : intersect(idom, fanin);
+      }
+      idoms[i] = idom == NO_INDEX ? ROOT : idom;
+    }
+
+    // Children of the nodes in the compressed form.
+    std::vector<Index> offsets(size + 1, 0);
+    for (Index i = 1; i < size; ++i) {
+      ++offsets[idoms[i] + 1];
+    }
+    for (Index i = 0; i < size; ++i) {
+      offsets[i + 1] += offsets[i];
+    }
+    std::vector<Index> children(size - 1);
+    std::vector<Index> filled(offsets.begin(), offsets.end() - 1);
+    for (Index i = 1; i < size; ++i) {
+      children[filled[idoms[i]]++] = i;
+    }
+
+    // The exit time of a node is the last entry time in its subtree.
+    entries.assign(size, 0);
+    exits.assign(size, 0);
+    Index time = 0;
+    std::vector<std::pair<Index, Index>> stack{{ROOT, offsets[ROOT]}};
+    entries[ROOT] = time++;
+    while (!stack.empty()) {
+      auto &[node, next] = stack.back();
+      if (next == offsets[node + 1]) {
+        exits[node] = time - 1;
+        stack.pop_back();
+        continue;
+      }
+      const Index child = children[next++];
+      entries[child] = time++;
+      stack.emplace_back(child, offsets[child]);
+    }
+  }
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+#include "gate/optimizer/levelization.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Dominator tree of the nodes from the sources to the sinks.
+  * \ A node D dominates a node N if every path from a source to N passes
+  * \ through D (a node dominates itself). The sources and the nodes with
+  * \ fanins out of the order are the children of the virtual root.
+  * \ The immediate dominators are found in one pass over the topological
+  * \ order (Cooper, Harvey, Kennedy). Dominance is checked in O(1) with
+  * \ the entry and exit times of a depth-first search over the tree.
+  */
+  class DominatorTree {
+
+  public:
+    using GNet = model::GNet;
+    using GateId = GNet::GateId;
+
+    /// Immediate dominator of the children of the virtual root.
+    static constexpr GateId NO_DOMINATOR = ~GateId(0);
+
+    /**
+     * @param topoOrder Nodes in topological order.
+     */
+    explicit DominatorTree(const std::vector<GateId> &topoOrder);
+
+    /**
+     * @param levelization Cached order of the net (it must be invalidated
+     * if the net was edited since the order was computed).
+     */
+    explicit DominatorTree(Levelization &levelization);
+
+    /// Checks whether the node is in the tree.
+    bool contains(GateId node) const {
+      return indexOf(node) != NO_INDEX;
+    }
+
+    /// Returns the number of the nodes.
+    size_t size() const { return order.size(); }
+
+    /// Returns the immediate dominator of the node or NO_DOMINATOR.
+    GateId getIdom(GateId node) const {
+      const auto idom = idoms[indexOf(node)];
+      return idom == ROOT ? NO_DOMINATOR : order[idom - 1];
+    }
+
+    /// Checks whether the node dominates the other one.
+    bool dominates(GateId dominator, GateId node) const {
+      const auto d = indexOf(dominator);
+      const auto n = indexOf(node);
+      return entries[d] <= entries[n] && exits[n] <= exits[d];
+    }
+
+    /// Returns the dominators of the node from the node itself upwards.
+    std::vector<GateId> getDominators(GateId node) const;
+
+  private:
+    using Index = uint32_t;
+
+    static constexpr Index NO_INDEX = ~Index(0);
+    static constexpr Index ROOT = 0;
+
+    void build();
+
+    Index intersect(Index lhs, Index rhs) const;
+
+    Index indexOf(GateId node) const {
+      if (node < minId || node - minId >= indices.size()) {
+        return NO_INDEX;
+      }
+      return indices[node - minId];
+    }
+
+    // Node indices are the positions in the order plus one.
+    std::vector<GateId> order;
+    // Indices of the nodes [minId, minId + indices.size()).
+    std::vector<Index> indices;
+    GateId minId = 0;
+    std::vector<Index> idoms;
+    std::vector<Index> entries;
+    std::vector<Index> exits;
+  };
+
+} // namespace eda::gate::optimizer
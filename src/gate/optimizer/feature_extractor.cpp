@@ -0,0 +1,337 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/feature_extractor.h"
+#include "gate/optimizer/npn/npn_collector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace eda::gate::optimizer {
+
+  using Gate = model::Gate;
+  using GateSymbol = model::GateSymbol;
+
+  // Classes of the gate functions (the inverted functions are joined).
+  enum FunctionClass { AND_CLASS, OR_CLASS, XOR_CLASS, MAJ_CLASS, NOT_CLASS,
+                       BUF_CLASS, OTHER_CLASS, CLASSES_NUMBER };
+
+  static const char *CLASS_NAMES[] = {
+    "and", "or", "xor", "maj", "not", "buf", "other"
+  };
+
+  static FunctionClass getFunctionClass(GateSymbol func) {
+    switch (func) {
+    case GateSymbol::AND:
+    case GateSymbol::NAND:
+      return AND_CLASS;
+    case GateSymbol::OR:
+    case GateSymbol::NOR:
+      return OR_CLASS;
+    case GateSymbol::XOR:
+    case GateSymbol::XNOR:
+      return XOR_CLASS;
+    case GateSymbol::MAJ:
+      return MAJ_CLASS;
+    case GateSymbol::NOT:
+      return NOT_CLASS;
+    case GateSymbol::NOP:
+      return BUF_CLASS;
+    default:
+      return OTHER_CLASS;
+    }
+  }
+
+  // Inputs, outputs and constants are not logic gates.
+  static bool isLogic(const Gate *gate) {
+    return !gate->isSource() && !gate->isTarget() && !gate->isValue();
+  }
+
+  static float ratio(double value, double total) {
+    return total > 0 ? static_cast<float>(value / total) : 0.f;
+  }
+
+  static size_t getRemaining(std::istream &stream) {
+    const auto position = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    const auto end = stream.tellg();
+    stream.seekg(position);
+    return position < 0 || end < position ? 0 : end - position;
+  }
+
+  FeatureExtractor::FeatureExtractor(const FeatureOptions &options) :
+      options(options) {
+    names = {"inputs", "outputs", "gates", "ands", "inverted_edges", "depth"};
+    for (const char *name: CLASS_NAMES) {
+      names.push_back(std::string("ratio_") + name);
+    }
+    names.push_back("width_max");
+    names.push_back("width_mean");
+    for (size_t i = 0; i < options.levelBins; ++i) {
+      names.push_back("width_bin_" + std::to_string(i));
+    }
+    names.insert(names.end(), {"fanout_mean", "fanout_std", "fanout_skew",
+                               "fanout_max", "fanout_stems"});
+    names.insert(names.end(), {"reconv_gates", "reconv_ratio"});
+    names.push_back("path_length");
+    for (const char *name: CLASS_NAMES) {
+      names.push_back(std::string("path_") + name);
+    }
+    names.insert(names.end(), {"npn_classes", "npn_top_share"});
+    for (size_t i = 0; i < options.npnBins; ++i) {
+      names.push_back("npn_bin_" + std::to_string(i));
+    }
+  }
+
+  void FeatureExtractor::addFeature(const std::string &name, Feature feature) {
+    names.push_back(name);
+    features.push_back(std::move(feature));
+  }
+
+  void FeatureExtractor::extract(const GNet *net, float *row,
+                                 Levelization *levelization,
+                                 const NPNCollector *npnCollector) {
+    Levelization local(net);
+    const auto &order = (levelization ? *levelization : local).getOrder();
+
+    float *next = collectStructure(net, order, row);
+    next = collectNPN(npnCollector, next);
+    for (const auto &feature: features) {
+      *next++ = feature(*net);
+    }
+  }
+
+  std::vector<float> FeatureExtractor::extract(
+      const GNet *net, Levelization *levelization,
+      const NPNCollector *npnCollector) {
+    std::vector<float> row(size());
+    extract(net, row.data(), levelization, npnCollector);
+    return row;
+  }
+
+  float *FeatureExtractor::collectStructure(const GNet *net,
+                                            const std::vector<GateId> &order,
+                                            float *row) {
+    // The arrays are indexed by the identifiers offset by the minimal one
+    // (like in CsrGraph), the identifiers out of the range are not stored.
+    const auto [minIt, maxIt] = std::minmax_element(order.begin(), order.end());
+    const GateId minId = order.empty() ? 0 : *minIt;
+    const size_t size = order.empty() ? 0 : *maxIt - minId + 1;
+    const auto index = [&](GateId id) -> size_t {
+      return id < minId ? size : std::min<size_t>(id - minId, size);
+    };
+    levels.assign(size, -1);
+    fanouts.assign(size, 0);
+    critical.assign(size, 0);
+    stamps.assign(size, 0);
+    owners.assign(size, 0);
+
+    size_t nAnds = 0, nNots = 0, nLogic = 0, nReconv = 0;
+    size_t classes[CLASSES_NUMBER] = {};
+    int32_t maxLevel = -1;
+    GateId end = 0;
+
+    // The first pass: levels, fanouts, functions and reconvergences.
+    for (size_t position = 0; position < order.size(); ++position) {
+      const GateId gate = order[position];
+      const size_t gateIndex = index(gate);
+      const Gate *link = Gate::get(gate);
+      const auto &inputs = link->inputs();
+
+      int32_t level = 0;
+      for (const auto &input: inputs) {
+        const size_t fanin = index(input.node());
+        if (fanin == size || levels[fanin] < 0) {
+          continue;
+        }
+        ++fanouts[fanin];
+        if (levels[fanin] + 1 > level) {
+          level = levels[fanin] + 1;
+          critical[gateIndex] = input.node();
+        }
+      }
+      levels[gateIndex] = level;
+      if (level > maxLevel) {
+        maxLevel = level;
+        end = gate;
+      }
+
+      nAnds += link->isAnd();
+      nNots += link->isNot();
+      if (!isLogic(link)) {
+        continue;
+      }
+      ++nLogic;
+      ++classes[getFunctionClass(link->func())];
+
+      // The gate is reconvergent if two fanins share a fanin
+      // or if a fanin feeds another one.
+      const uint32_t stamp = position + 1;
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        const size_t fanin = index(inputs[i].node());
+        if (fanin < size && stamps[fanin] != stamp) {
+          stamps[fanin] = stamp;
+          owners[fanin] = i;
+        }
+      }
+      bool reconvergent = false;
+      for (size_t i = 0; i < inputs.size() && !reconvergent; ++i) {
+        const size_t fanin = index(inputs[i].node());
+        // A repeated fanin is handled once.
+        if (fanin == size || levels[fanin] < 0 || owners[fanin] != i) {
+          continue;
+        }
+        for (const auto &input: Gate::get(inputs[i].node())->inputs()) {
+          const size_t node = index(input.node());
+          if (node == size) {
+            continue;
+          }
+          if (stamps[node] != stamp) {
+            stamps[node] = stamp;
+            owners[node] = i;
+          } else if (owners[node] != i) {
+            reconvergent = true;
+            break;
+          }
+        }
+      }
+      nReconv += reconvergent;
+    }
+
+    const size_t depth = maxLevel + 1;
+    *row++ = net->nSourceLinks();
+    *row++ = net->nTargetLinks();
+    *row++ = net->nGates();
+    *row++ = nAnds;
+    *row++ = nNots;
+    *row++ = std::max<int32_t>(maxLevel, 0);
+    for (size_t i = 0; i < CLASSES_NUMBER; ++i) {
+      *row++ = ratio(classes[i], nLogic);
+    }
+
+    // The second pass: level widths and fanout moments.
+    widths.assign(depth, 0);
+    double sum = 0, sum2 = 0, sum3 = 0;
+    uint32_t maxFanout = 0;
+    size_t nStems = 0, nDrivers = 0;
+    for (GateId gate: order) {
+      const size_t gateIndex = index(gate);
+      ++widths[levels[gateIndex]];
+      if (Gate::get(gate)->isTarget()) {
+        continue;
+      }
+      const double fanout = fanouts[gateIndex];
+      sum += fanout;
+      sum2 += fanout * fanout;
+      sum3 += fanout * fanout * fanout;
+      maxFanout = std::max(maxFanout, fanouts[gateIndex]);
+      nStems += fanouts[gateIndex] > 1;
+      ++nDrivers;
+    }
+
+    float *bin = row + 2;
+    std::fill(bin, bin + options.levelBins, 0.f);
+    uint32_t maxWidth = 0;
+    for (size_t level = 0; level < depth; ++level) {
+      maxWidth = std::max(maxWidth, widths[level]);
+      if (options.levelBins) {
+        bin[level * options.levelBins / depth] += ratio(widths[level],
+                                                        order.size());
+      }
+    }
+    *row++ = maxWidth;
+    *row++ = ratio(order.size(), depth);
+    row += options.levelBins;
+
+    const double mean = nDrivers ? sum / nDrivers : 0;
+    const double variance =
+        nDrivers ? std::max(0.0, sum2 / nDrivers - mean * mean) : 0;
+    const double deviation = std::sqrt(variance);
+    const double moment3 = nDrivers ? sum3 / nDrivers
+        - 3 * mean * sum2 / nDrivers + 2 * mean * mean * mean : 0;
+    *row++ = mean;
+    *row++ = deviation;
+    *row++ = deviation > 0 ? moment3 / (variance * deviation) : 0;
+    *row++ = maxFanout;
+    *row++ = ratio(nStems, nDrivers);
+
+    *row++ = nReconv;
+    *row++ = ratio(nReconv, nLogic);
+
+    // The critical path is traced back from the deepest gate.
+    size_t pathClasses[CLASSES_NUMBER] = {};
+    size_t pathLogic = 0;
+    for (GateId gate = end; !order.empty(); gate = critical[index(gate)]) {
+      const Gate *link = Gate::get(gate);
+      if (isLogic(link)) {
+        ++pathClasses[getFunctionClass(link->func())];
+        ++pathLogic;
+      }
+      if (levels[index(gate)] == 0) {
+        break;
+      }
+    }
+    *row++ = pathLogic;
+    for (size_t i = 0; i < CLASSES_NUMBER; ++i) {
+      *row++ = ratio(pathClasses[i], pathLogic);
+    }
+    return row;
+  }
+
+  float *FeatureExtractor::collectNPN(const NPNCollector *npnCollector,
+                                      float *row) const {
+    float *bins = row + 2;
+    std::fill(row, bins + options.npnBins, 0.f);
+    if (!npnCollector) {
+      return bins + options.npnBins;
+    }
+
+    size_t total = 0, top = 0;
+    const auto &statistics = npnCollector->getNPNStatistics();
+    for (const auto &[npnClass, data]: statistics) {
+      total += data.count;
+      top = std::max(top, data.count);
+    }
+    for (const auto &[npnClass, data]: statistics) {
+      if (!options.npnBins) {
+        break;
+      }
+      // The classes are spread over the bins by a multiplicative hash.
+      const uint64_t hash = npnClass * 0x9E3779B97F4A7C15ull;
+      bins[(hash >> 32) % options.npnBins] += ratio(data.count, total);
+    }
+    row[0] = statistics.size();
+    row[1] = ratio(top, total);
+    return bins + options.npnBins;
+  }
+
+  void FeatureExtractor::writeRow(std::ostream &stream, const float *row,
+                                  size_t size) {
+    const uint32_t count = size;
+    stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    stream.write(reinterpret_cast<const char*>(row), size * sizeof(float));
+  }
+
+  bool FeatureExtractor::readRow(std::istream &stream,
+                                 std::vector<float> &row) {
+    uint32_t count;
+    if (!stream.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+      return false;
+    }
+    // The count of a malformed stream is not trusted.
+    if (count > getRemaining(stream) / sizeof(float)) {
+      stream.setstate(std::ios::failbit);
+      return false;
+    }
+    row.resize(count);
+    return static_cast<bool>(
+        stream.read(reinterpret_cast<char*>(row.data()),
+                    count * sizeof(float)));
+  }
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+#include "gate/optimizer/levelization.h"
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+  class NPNCollector;
+
+  /// Columns of the plain parameters passed to the legacy predict_quality()
+  /// model: inputs, outputs, ANDs, inverted edges and depth.
+  constexpr size_t PLAIN_PARAMETER_COLUMNS[] = {0, 1, 3, 4, 5};
+
+  /// Widths of the histograms of the feature vector.
+  struct FeatureOptions {
+    // Bins of the level width histogram.
+    size_t levelBins = 16;
+    // Bins of the NPN class histogram.
+    size_t npnBins = 32;
+  };
+
+ /**
+  * \brief Structural features of a net used to rank synthesis scenarios.
+  * \ The vector contains the plain parameters, the gate function ratios,
+  * \ the width histogram of the normalized levels, the fanout moments,
+  * \ the local reconvergence counts, the gate mix of a critical path and
+  * \ the NPN class histogram. The features are computed in two linear
+  * \ passes over the topological order. The width of the vector depends
+  * \ on the options and on the added features only, so the vectors of
+  * \ different nets may be stored as the rows of one matrix.
+  */
+  class FeatureExtractor {
+
+  public:
+    using GNet = model::GNet;
+    using GateId = GNet::GateId;
+    using Feature = std::function<float(const GNet &)>;
+
+    explicit FeatureExtractor(const FeatureOptions &options = FeatureOptions());
+
+    /**
+     * Appends a user-defined feature to the vector.
+     * @param name Name of the feature.
+     * @param feature Function computing the feature of a net.
+     */
+    void addFeature(const std::string &name, Feature feature);
+
+    /// Returns the names of the features in the vector order.
+    const std::vector<std::string> &getNames() const { return names; }
+
+    /// Returns the number of the features.
+    size_t size() const { return names.size(); }
+
+    /**
+     * Computes the features of the net.
+     * @param net Net the features are computed for.
+     * @param row Output array of size() elements.
+     * @param levelization Cached order of the net (may be null), valid for
+     * the current state of the net.
+     * @param npnCollector Collector processed for the net (if null,
+     * the NPN histogram is zero).
+     */
+    void extract(const GNet *net, float *row,
+                 Levelization *levelization = nullptr,
+                 const NPNCollector *npnCollector = nullptr);
+
+    std::vector<float> extract(const GNet *net,
+                               Levelization *levelization = nullptr,
+                               const NPNCollector *npnCollector = nullptr);
+
+    /**
+     * Writes the row in the binary format: the number of the features
+     * (uint32_t) followed by the features (float), in the host byte order.
+     */
+    static void writeRow(std::ostream &stream, const float *row, size_t size);
+
+    /**
+     * Reads a row written by writeRow() from a seekable stream.
+     * @return false at the end of the stream or if the number of the
+     * features exceeds the remaining size of the stream.
+     */
+    static bool readRow(std::istream &stream, std::vector<float> &row);
+
+  private:
+    // Returns the position of the next feature.
+    float *collectStructure(const GNet *net, const std::vector<GateId> &order,
+                            float *row);
+
+    float *collectNPN(const NPNCollector *npnCollector, float *row) const;
+
+    const FeatureOptions options;
+
+    std::vector<std::string> names;
+    std::vector<Feature> features;
+
+    // Dense arrays indexed by the gate identifiers offset by the minimal
+    // one of the net (the critical fanins are identifiers).
+    std::vector<int32_t> levels;
+    std::vector<uint32_t> fanouts;
+    std::vector<GateId> critical;
+    std::vector<uint32_t> stamps;
+    std::vector<uint32_t> owners;
+    std::vector<uint32_t> widths;
+  };
+
+} // namespace eda::gate::optimizer
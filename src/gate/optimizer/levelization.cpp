@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/levelization.h"
+#include "util/graph.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace eda::gate::optimizer {
+
+  using Gate = model::Gate;
+
+  Levelization::Levelization(const GNet *net) : net(net) {}
+
+  const std::vector<Levelization::GateId> &Levelization::getOrder() {
+    update();
+    return order;
+  }
+
+  size_t Levelization::getLevel(GateId gate) {
+    update();
+    assert(gate >= minId && gate - minId < levels.size() &&
+           levels[gate - minId] != NO_LEVEL && "Gate is not in the net");
+    return levels[gate - minId];
+  }
+
+  const std::vector<Levelization::Level> &Levelization::getLevels() {
+    update();
+    return buckets;
+  }
+
+  size_t Levelization::getDepth() {
+    update();
+    return buckets.size();
+  }
+
+  void Levelization::invalidate() {
+    valid = false;
+  }
+
+  bool Levelization::checkOrder() {
+    update();
+    if (order.size() != net->nGates()) {
+      return false;
+    }
+    // Positions of the gates in the order plus one (0 if out of it).
+    std::vector<uint32_t> positions(levels.size(), 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+      positions[order[i] - minId] = i + 1;
+    }
+    // The fanins out of the order are skipped like in update().
+    for (size_t i = 0; i < order.size(); ++i) {
+      for (const auto &input: Gate::get(order[i])->inputs()) {
+        const GateId fanin = input.node();
+        if (fanin >= minId && fanin - minId < positions.size() &&
+            positions[fanin - minId] > i) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void Levelization::update() {
+    if (valid && order.size() == net->nGates()) {
+      return;
+    }
+
+    order = utils::graph::topologicalSort(*net);
+    const auto [minIt, maxIt] = std::minmax_element(order.begin(), order.end());
+    minId = order.empty() ? 0 : *minIt;
+    levels.assign(order.empty() ? 0 : *maxIt - minId + 1, NO_LEVEL);
+    buckets.clear();
+
+    for (GateId gate: order) {
+      uint32_t level = 0;
+      for (const auto &input: Gate::get(gate)->inputs()) {
+        const GateId fanin = input.node();
+        if (fanin >= minId && fanin - minId < levels.size() &&
+            levels[fanin - minId] != NO_LEVEL) {
+          level = std::max(level, levels[fanin - minId] + 1);
+        }
+      }
+      levels[gate - minId] = level;
+
+      if (buckets.size() <= level) {
+        buckets.resize(level + 1);
+      }
+      buckets[level].push_back(gate);
+    }
+    valid = true;
+  }
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Cached topological order and logic levels of a net.
+  * \ The level of a gate is 0 if it has no fanins in the net, otherwise
+  * \ it is the maximum level of the fanins plus one. The data are computed
+  * \ on the first request and kept until invalidate() is called. The net
+  * \ has no modification stamp, so only a change of the number of its
+  * \ gates is detected: invalidate() must be called after the gates are
+  * \ reconnected (rmRecursive() and CutsFindVisitor::update() do it if
+  * \ they are given the levelization).
+  */
+  class Levelization {
+
+  public:
+    using GNet = model::GNet;
+    using GateId = GNet::GateId;
+    using Level = std::vector<GateId>;
+
+    explicit Levelization(const GNet *net);
+
+    /// Returns the gates of the net in topological order.
+    const std::vector<GateId> &getOrder();
+
+    /// Returns the level of the net gate.
+    size_t getLevel(GateId gate);
+
+    /**
+     * Returns the gates grouped by levels (each group in topological order).
+     * The gates of a level do not depend on each other, so they may be
+     * handled concurrently after the lower levels.
+     */
+    const std::vector<Level> &getLevels();
+
+    /// Returns the number of levels (the longest path length plus one).
+    size_t getDepth();
+
+    /// Drops the cached data, it must be called after the net is modified.
+    void invalidate();
+
+    /**
+     * Checks that the cached order is a topological order of the net
+     * (it is used by the debug assertions of the walkers).
+     */
+    bool checkOrder();
+
+  private:
+    static constexpr uint32_t NO_LEVEL = ~uint32_t(0);
+
+    void update();
+
+    const GNet *net;
+    bool valid = false;
+
+    std::vector<GateId> order;
+    // Levels of the gates [minId, minId + levels.size()) like in CsrGraph.
+    std::vector<uint32_t> levels;
+    GateId minId = 0;
+    std::vector<Level> buckets;
+  };
+
+} // namespace eda::gate::optimizer
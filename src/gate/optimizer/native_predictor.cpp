@@ -0,0 +1,374 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/native_predictor.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace eda::gate::optimizer {
+
+  static constexpr uint32_t MAGIC = 0x4d505455; // "UTPM"
+  static constexpr uint32_t VERSION = 1;
+
+  // Maximum number of the pairs scored at once.
+  static constexpr size_t BLOCK_SIZE = 256;
+
+  template <typename T>
+  static bool readValue(std::istream &stream, T &value) {
+    return static_cast<bool>(
+        stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+
+  // Returns the number of the bytes left in the stream.
+  static size_t getRemaining(std::istream &stream) {
+    const auto position = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    const auto end = stream.tellg();
+    stream.seekg(position);
+    return position < 0 || end < position ? 0 : end - position;
+  }
+
+  template <typename T>
+  static bool readArray(std::istream &stream, std::vector<T> &values,
+                        size_t size) {
+    // The sizes of a malformed file are not trusted.
+    if (size > getRemaining(stream) / sizeof(T)) {
+      return false;
+    }
+    values.resize(size);
+    return static_cast<bool>(
+        stream.read(reinterpret_cast<char*>(values.data()), size * sizeof(T)));
+  }
+
+  template <typename T>
+  static void writeValue(std::ostream &stream, const T &value) {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  static void writeArray(std::ostream &stream, const std::vector<T> &values) {
+    stream.write(reinterpret_cast<const char*>(values.data()),
+                 values.size() * sizeof(T));
+  }
+
+  NativeScenarioPredictor::NativeScenarioPredictor(
+      Kind kind, size_t featuresNumber, const std::vector<std::string> &steps) :
+      kind(kind), featuresNumber(featuresNumber), steps(steps) {
+    for (uint32_t i = 0; i < steps.size(); ++i) {
+      stepIndices.emplace(steps[i], i);
+    }
+  }
+
+  void NativeScenarioPredictor::addTree(const std::vector<TreeNode> &tree) {
+    const uint32_t root = nodes.size();
+    roots.push_back(root);
+    for (TreeNode node: tree) {
+      if (node.feature >= 0) {
+        node.left += root;
+        node.right += root;
+      }
+      nodes.push_back(node);
+    }
+  }
+
+  void NativeScenarioPredictor::addLayer(const Layer &layer) {
+    layers.push_back(layer);
+
+    std::vector<float> weights(layer.weights.size());
+    if (weights.size() != size_t(layer.inputs) * layer.outputs) {
+      // The layer is rejected by isValid().
+      transposed.push_back(std::move(weights));
+      return;
+    }
+    for (uint32_t i = 0; i < layer.inputs; ++i) {
+      for (uint32_t o = 0; o < layer.outputs; ++o) {
+        weights[i * layer.outputs + o] = layer.weights[o * layer.inputs + i];
+      }
+    }
+    transposed.push_back(std::move(weights));
+  }
+
+  bool NativeScenarioPredictor::isValid() const {
+    const size_t inputs = getInputsNumber();
+    if (kind == GBDT) {
+      for (size_t i = 0; i < roots.size(); ++i) {
+        const size_t end = i + 1 < roots.size() ? roots[i + 1] : nodes.size();
+        for (size_t j = roots[i]; j < end; ++j) {
+          const TreeNode &node = nodes[j];
+          // The children follow their parents, so the trees are finite.
+          if (node.feature >= 0 && (static_cast<size_t>(node.feature) >= inputs
+              || node.left <= j || node.left >= end
+              || node.right <= j || node.right >= end)) {
+            return false;
+          }
+        }
+        if (roots[i] == end) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    size_t size = inputs;
+    for (const auto &layer: layers) {
+      if (layer.inputs != size || layer.activation > TANH
+          || layer.weights.size() != size_t(layer.inputs) * layer.outputs
+          || layer.biases.size() != layer.outputs) {
+        return false;
+      }
+      size = layer.outputs;
+    }
+    return !layers.empty() && size == 1;
+  }
+
+  std::unique_ptr<NativeScenarioPredictor>
+  NativeScenarioPredictor::load(const std::string &filename) {
+    std::ifstream stream(filename, std::ios::binary);
+    uint32_t magic, version, kind, featuresNumber, stepsNumber;
+    if (!readValue(stream, magic) || magic != MAGIC
+        || !readValue(stream, version) || version != VERSION
+        || !readValue(stream, kind) || kind > MLP
+        || !readValue(stream, featuresNumber)
+        || !readValue(stream, stepsNumber)) {
+      fprintf(stderr, "Cannot read the model header from \"%s\"\n",
+              filename.c_str());
+      return nullptr;
+    }
+
+    std::vector<std::string> steps(stepsNumber);
+    for (auto &step: steps) {
+      uint32_t length;
+      std::vector<char> chars;
+      if (!readValue(stream, length) || !readArray(stream, chars, length)) {
+        return nullptr;
+      }
+      step.assign(chars.begin(), chars.end());
+    }
+
+    auto model = std::make_unique<NativeScenarioPredictor>(
+        static_cast<Kind>(kind), featuresNumber, steps);
+    uint32_t count;
+    bool success = true;
+    if (kind == GBDT) {
+      success = readValue(stream, model->baseScore) && readValue(stream, count);
+      for (uint32_t i = 0; success && i < count; ++i) {
+        uint32_t size;
+        std::vector<TreeNode> tree;
+        success = readValue(stream, size) && readArray(stream, tree, size);
+        model->addTree(tree);
+      }
+    } else {
+      success = readValue(stream, count);
+      for (uint32_t i = 0; success && i < count; ++i) {
+        Layer layer;
+        success = readValue(stream, layer.inputs)
+            && readValue(stream, layer.outputs)
+            && readValue(stream, layer.activation)
+            && readArray(stream, layer.weights,
+                         size_t(layer.inputs) * layer.outputs)
+            && readArray(stream, layer.biases, layer.outputs);
+        model->addLayer(layer);
+      }
+    }
+
+    if (!success || !model->isValid()) {
+      fprintf(stderr, "Malformed model \"%s\"\n", filename.c_str());
+      return nullptr;
+    }
+    return model;
+  }
+
+  bool NativeScenarioPredictor::save(const std::string &filename) const {
+    std::ofstream stream(filename, std::ios::binary);
+    writeValue(stream, MAGIC);
+    writeValue(stream, VERSION);
+    writeValue(stream, static_cast<uint32_t>(kind));
+    writeValue(stream, static_cast<uint32_t>(featuresNumber));
+    writeValue(stream, static_cast<uint32_t>(steps.size()));
+    for (const auto &step: steps) {
+      writeValue(stream, static_cast<uint32_t>(step.size()));
+      stream.write(step.data(), step.size());
+    }
+
+    if (kind == GBDT) {
+      writeValue(stream, baseScore);
+      writeValue(stream, static_cast<uint32_t>(roots.size()));
+      for (size_t i = 0; i < roots.size(); ++i) {
+        const uint32_t root = roots[i];
+        const size_t end = i + 1 < roots.size() ? roots[i + 1] : nodes.size();
+        writeValue(stream, static_cast<uint32_t>(end - root));
+        for (size_t j = root; j < end; ++j) {
+          TreeNode node = nodes[j];
+          if (node.feature >= 0) {
+            node.left -= root;
+            node.right -= root;
+          }
+          writeValue(stream, node);
+        }
+      }
+    } else {
+      writeValue(stream, static_cast<uint32_t>(layers.size()));
+      for (const auto &layer: layers) {
+        writeValue(stream, layer.inputs);
+        writeValue(stream, layer.outputs);
+        writeValue(stream, layer.activation);
+        writeArray(stream, layer.weights);
+        writeArray(stream, layer.biases);
+      }
+    }
+    return static_cast<bool>(stream);
+  }
+
+  void NativeScenarioPredictor::encode(const std::string &scenario,
+                                       float *encoding) const {
+    std::fill(encoding, encoding + steps.size() + 1, 0.f);
+    size_t begin = 0;
+    while (begin < scenario.size()) {
+      size_t end = scenario.find_first_of(" \t,;", begin);
+      if (end == std::string::npos) {
+        end = scenario.size();
+      }
+      if (end > begin) {
+        auto found = stepIndices.find(scenario.substr(begin, end - begin));
+        if (found != stepIndices.end()) {
+          encoding[found->second] += 1.f;
+        }
+        encoding[steps.size()] += 1.f;
+      }
+      begin = end + 1;
+    }
+  }
+
+  bool NativeScenarioPredictor::predict(
+      const float *features, size_t rows, size_t columns,
+      const std::vector<std::string> &scenarios,
+      std::vector<double> &qualities) {
+    assert(isValid() && "Malformed model");
+    if (columns != featuresNumber) {
+      fprintf(stderr, "The model expects %zu features, %zu are given\n",
+              featuresNumber, columns);
+      return false;
+    }
+
+    const size_t width = getInputsNumber();
+    const size_t encodingSize = steps.size() + 1;
+    std::vector<float> encodings(scenarios.size() * encodingSize);
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+      encode(scenarios[i], &encodings[i * encodingSize]);
+    }
+
+    qualities.resize(rows * scenarios.size());
+    std::vector<float> inputs(BLOCK_SIZE * width);
+    for (size_t row = 0; row < rows; ++row) {
+      const float *design = features + row * columns;
+      double *scores = &qualities[row * scenarios.size()];
+
+      for (size_t first = 0; first < scenarios.size(); first += BLOCK_SIZE) {
+        const size_t count = std::min(BLOCK_SIZE, scenarios.size() - first);
+        for (size_t i = 0; i < count; ++i) {
+          float *input = &inputs[i * width];
+          std::copy(design, design + columns, input);
+          const float *encoding = &encodings[(first + i) * encodingSize];
+          std::copy(encoding, encoding + encodingSize, input + columns);
+        }
+        evaluate(inputs.data(), count, scores + first);
+      }
+    }
+    return true;
+  }
+
+  void NativeScenarioPredictor::evaluate(const float *inputs, size_t count,
+                                         double *scores) const {
+    if (kind == GBDT) {
+      evaluateTrees(inputs, count, scores);
+    } else {
+      evaluateLayers(inputs, count, scores);
+    }
+  }
+
+  void NativeScenarioPredictor::evaluateTrees(const float *inputs,
+                                              size_t count,
+                                              double *scores) const {
+    const size_t width = getInputsNumber();
+    std::fill(scores, scores + count, baseScore);
+
+    // A tree at a time keeps its nodes in the cache for all the inputs.
+    for (uint32_t root: roots) {
+      for (size_t i = 0; i < count; ++i) {
+        const float *input = inputs + i * width;
+        const TreeNode *node = &nodes[root];
+        while (node->feature >= 0) {
+          node = &nodes[input[node->feature] < node->value
+                        ? node->left : node->right];
+        }
+        scores[i] += node->value;
+      }
+    }
+  }
+
+  void NativeScenarioPredictor::evaluateLayers(const float *inputs,
+                                               size_t count,
+                                               double *scores) const {
+    thread_local std::vector<float> values, outputs;
+    const float *current = inputs;
+
+    for (size_t l = 0; l < layers.size(); ++l) {
+      const Layer &layer = layers[l];
+      const float *weights = transposed[l].data();
+      outputs.resize(count * layer.outputs);
+
+      for (size_t i = 0; i < count; ++i) {
+        const float *in = current + i * layer.inputs;
+        float *out = &outputs[i * layer.outputs];
+        std::copy(layer.biases.begin(), layer.biases.end(), out);
+        // The inner loop has no dependencies between the iterations.
+        for (uint32_t j = 0; j < layer.inputs; ++j) {
+          const float value = in[j];
+          const float *column = weights + j * layer.outputs;
+          for (uint32_t o = 0; o < layer.outputs; ++o) {
+            out[o] += value * column[o];
+          }
+        }
+      }
+
+      float *out = outputs.data();
+      const size_t size = outputs.size();
+      switch (layer.activation) {
+      case RELU:
+        for (size_t k = 0; k < size; ++k) {
+          out[k] = out[k] > 0.f ? out[k] : 0.f;
+        }
+        break;
+      case SIGMOID:
+        for (size_t k = 0; k < size; ++k) {
+          out[k] = 1.f / (1.f + std::exp(-out[k]));
+        }
+        break;
+      case TANH:
+        for (size_t k = 0; k < size; ++k) {
+          out[k] = std::tanh(out[k]);
+        }
+        break;
+      default:
+        break;
+      }
+
+      values.swap(outputs);
+      current = values.data();
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      scores[i] = current[i];
+    }
+  }
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/optimizer/scenario_predictor.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Scenario predictor evaluating an exported model in process.
+  * \ The model is a gradient-boosted tree ensemble or a multilayer
+  * \ perceptron. Its input is the feature row of the design followed by
+  * \ the encoding of the scenario: the number of occurrences of every
+  * \ step of the vocabulary and the total number of steps. The steps are
+  * \ separated by spaces, commas or semicolons. The pairs are scored in
+  * \ batches: a tree at a time for the ensemble and a layer at a time for
+  * \ the perceptron (the inner loops are contiguous to be vectorized).
+  */
+  class NativeScenarioPredictor final : public ScenarioPredictor {
+
+  public:
+    enum Kind : uint32_t { GBDT = 0, MLP = 1 };
+
+    enum Activation : uint32_t { LINEAR = 0, RELU = 1, SIGMOID = 2, TANH = 3 };
+
+    /**
+     * Node of a tree: the inner nodes go left if input[feature] < value.
+     * The children are indexed in the tree and follow their parents.
+     */
+    struct TreeNode {
+      // Input index or -1 for a leaf.
+      int32_t feature;
+      // Threshold of an inner node or the value of a leaf.
+      float value;
+      uint32_t left;
+      uint32_t right;
+    };
+
+    /// Dense layer: outputs = activation(weights * inputs + biases).
+    struct Layer {
+      uint32_t inputs;
+      uint32_t outputs;
+      Activation activation;
+      // Row-major outputs * inputs matrix.
+      std::vector<float> weights;
+      std::vector<float> biases;
+    };
+
+    /**
+     * @param kind Kind of the model.
+     * @param featuresNumber Number of the design features.
+     * @param steps Vocabulary of the scenario steps.
+     */
+    NativeScenarioPredictor(Kind kind, size_t featuresNumber,
+                            const std::vector<std::string> &steps);
+
+    /**
+     * Loads a model saved by save().
+     * @return nullptr if the file cannot be read or is malformed.
+     */
+    static std::unique_ptr<NativeScenarioPredictor>
+    load(const std::string &filename);
+
+    /**
+     * Saves the model in the binary format (host byte order): the header
+     * (magic, version, kind, number of the features), the vocabulary and
+     * the trees (base score and nodes) or the layers.
+     */
+    bool save(const std::string &filename) const;
+
+    /// Sets the score added to the sum of the trees.
+    void setBaseScore(float score) { baseScore = score; }
+
+    /// Appends a tree to the ensemble (the root is the first node).
+    void addTree(const std::vector<TreeNode> &nodes);
+
+    /// Appends a layer to the perceptron (the last one has one output).
+    void addLayer(const Layer &layer);
+
+    /// Returns the number of the model inputs.
+    size_t getInputsNumber() const {
+      return featuresNumber + steps.size() + 1;
+    }
+
+    /// Checks the indices of the trees and the sizes of the layers.
+    bool isValid() const;
+
+    bool predict(const float *features, size_t rows, size_t columns,
+                 const std::vector<std::string> &scenarios,
+                 std::vector<double> &qualities) override;
+
+    bool isThreadSafe() const override { return true; }
+
+  private:
+    void encode(const std::string &scenario, float *encoding) const;
+
+    // Scores the row-major matrix of inputs.
+    void evaluate(const float *inputs, size_t count, double *scores) const;
+
+    void evaluateTrees(const float *inputs, size_t count,
+                       double *scores) const;
+
+    void evaluateLayers(const float *inputs, size_t count,
+                        double *scores) const;
+
+    const Kind kind;
+    const size_t featuresNumber;
+    std::vector<std::string> steps;
+    std::unordered_map<std::string, uint32_t> stepIndices;
+
+    float baseScore = 0.f;
+    // Nodes of all the trees and the indices of the roots.
+    std::vector<TreeNode> nodes;
+    std::vector<uint32_t> roots;
+
+    std::vector<Layer> layers;
+    // Input-major (transposed) weights of the layers.
+    std::vector<std::vector<float>> transposed;
+  };
+
+} // namespace eda::gate::optimizer
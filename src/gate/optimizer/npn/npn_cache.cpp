@@ -0,0 +1,220 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/npn/npn_cache.h"
+
+#include <kitty/npn.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+namespace eda::gate::optimizer {
+
+    constexpr size_t SMALL_TABLES = 1 << 16;
+    constexpr char CACHE_MAGIC[4] = {'N', 'P', 'N', 'C'};
+    constexpr uint32_t CACHE_VERSION = 1;
+
+    NPNCache::NPNCache(size_t shardsNumber) :
+            small(new SmallEntry[SMALL_TABLES]),
+            shards(new Shard[std::max<size_t>(1, shardsNumber)]),
+            shardsNumber(std::max<size_t>(1, shardsNumber)) {}
+
+    bool NPNCache::isSmallFunction(uint64_t table) {
+        return (table & 0xFFFF) * 0x0001000100010001ull == table;
+    }
+
+    NPNTransform NPNCache::canonize(uint64_t table) {
+        if (isSmallFunction(table)) {
+            SmallEntry &entry = small[table & 0xFFFF];
+            uint64_t packed = entry.transform.load(std::memory_order_acquire);
+            if (packed & FILLED) {
+                nHits.fetch_add(1, std::memory_order_relaxed);
+                return unpack(entry.canonical.load(std::memory_order_relaxed),
+                              packed);
+            }
+            nMisses.fetch_add(1, std::memory_order_relaxed);
+            NPNTransform transform = compute(table);
+            insert(table, transform);
+            return transform;
+        }
+
+        Shard &shard = getShard(table);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto found = shard.entries.find(table);
+            if (found != shard.entries.end()) {
+                nHits.fetch_add(1, std::memory_order_relaxed);
+                return found->second;
+            }
+        }
+        // The function is canonized without the lock: concurrent misses
+        // on the same function give the same result.
+        nMisses.fetch_add(1, std::memory_order_relaxed);
+        NPNTransform transform = compute(table);
+        insert(table, transform);
+        return transform;
+    }
+
+    double NPNCache::hitRate() const {
+        size_t requests = hits() + misses();
+        return requests ? static_cast<double>(hits()) / requests : 0.0;
+    }
+
+    size_t NPNCache::size() const {
+        size_t result = nSmall.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < shardsNumber; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            result += shards[i].entries.size();
+        }
+        return result;
+    }
+
+    void NPNCache::clear() {
+        for (size_t i = 0; i < SMALL_TABLES; ++i) {
+            small[i].transform.store(0, std::memory_order_relaxed);
+        }
+        nSmall = 0;
+        for (size_t i = 0; i < shardsNumber; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            shards[i].entries.clear();
+        }
+        nHits = 0;
+        nMisses = 0;
+    }
+
+    bool NPNCache::save(const std::string &path) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            return false;
+        }
+
+        std::vector<uint64_t> words;
+        for (size_t i = 0; i < SMALL_TABLES; ++i) {
+            uint64_t packed = small[i].transform.load(std::memory_order_acquire);
+            if (packed & FILLED) {
+                words.push_back(i * 0x0001000100010001ull);
+                words.push_back(small[i].canonical.load(std::memory_order_relaxed));
+                words.push_back(packed);
+            }
+        }
+        for (size_t i = 0; i < shardsNumber; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            for (const auto &[table, transform]: shards[i].entries) {
+                words.push_back(table);
+                words.push_back(transform.canonical);
+                words.push_back(pack(transform));
+            }
+        }
+
+        uint64_t count = words.size() / 3;
+        out.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        out.write(reinterpret_cast<const char *>(&CACHE_VERSION),
+                  sizeof(CACHE_VERSION));
+        out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char *>(words.data()),
+                  words.size() * sizeof(uint64_t));
+        return static_cast<bool>(out);
+    }
+
+    bool NPNCache::load(const std::string &path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+
+        char magic[sizeof(CACHE_MAGIC)];
+        uint32_t version = 0;
+        uint64_t count = 0;
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char *>(&version), sizeof(version));
+        in.read(reinterpret_cast<char *>(&count), sizeof(count));
+        if (!in || !std::equal(magic, magic + sizeof(magic), CACHE_MAGIC) ||
+            version != CACHE_VERSION) {
+            return false;
+        }
+
+        // The count of a malformed file is not trusted.
+        const auto position = in.tellg();
+        in.seekg(0, std::ios::end);
+        const auto end = in.tellg();
+        in.seekg(position);
+        if (position < 0 || end < position ||
+            count > static_cast<uint64_t>(end - position) /
+                    (3 * sizeof(uint64_t))) {
+            return false;
+        }
+
+        std::vector<uint64_t> words(count * 3);
+        in.read(reinterpret_cast<char *>(words.data()),
+                words.size() * sizeof(uint64_t));
+        if (!in) {
+            return false;
+        }
+        for (size_t i = 0; i < words.size(); i += 3) {
+            insert(words[i], unpack(words[i + 1], words[i + 2]));
+        }
+        return true;
+    }
+
+    NPNTransform NPNCache::compute(uint64_t table) {
+        kitty::static_truth_table<6> kt;
+        kt._bits = table;
+        const auto [tt, phase, permutation] =
+                kitty::exact_npn_canonization(kt);
+
+        NPNTransform transform;
+        transform.canonical = tt._bits;
+        transform.phase = phase;
+        std::copy_n(permutation.begin(),
+                    std::min(permutation.size(), transform.permutation.size()),
+                    transform.permutation.begin());
+        return transform;
+    }
+
+    uint64_t NPNCache::pack(const NPNTransform &transform) {
+        uint64_t packed = FILLED | (transform.phase & 0x7F);
+        for (size_t i = 0; i < transform.permutation.size(); ++i) {
+            packed |= static_cast<uint64_t>(transform.permutation[i] & 7)
+                    << (8 + 3 * i);
+        }
+        return packed;
+    }
+
+    NPNTransform NPNCache::unpack(uint64_t canonical, uint64_t packed) {
+        NPNTransform transform;
+        transform.canonical = canonical;
+        transform.phase = packed & 0x7F;
+        for (size_t i = 0; i < transform.permutation.size(); ++i) {
+            transform.permutation[i] = (packed >> (8 + 3 * i)) & 7;
+        }
+        return transform;
+    }
+
+    NPNCache::Shard &NPNCache::getShard(uint64_t table) const {
+        // Fibonacci hashing spreads close tables over the shards.
+        return shards[((table * 0x9E3779B97F4A7C15ull) >> 32) % shardsNumber];
+    }
+
+    void NPNCache::insert(uint64_t table, const NPNTransform &transform) {
+        if (isSmallFunction(table)) {
+            SmallEntry &entry = small[table & 0xFFFF];
+            entry.canonical.store(transform.canonical, std::memory_order_relaxed);
+            uint64_t expected = 0;
+            if (entry.transform.compare_exchange_strong(
+                    expected, pack(transform), std::memory_order_release)) {
+                nSmall.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+
+        Shard &shard = getShard(table);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.emplace(table, transform);
+    }
+
+} // namespace eda::gate::optimizer
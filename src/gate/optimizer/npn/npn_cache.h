@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+    /// NPN representative of a function and the transform leading to it.
+    struct NPNTransform {
+        /// Canonical 6-variable truth table.
+        uint64_t canonical = 0;
+        /// Input negations (bits 0-5) and output negation (bit 6).
+        uint32_t phase = 0;
+        /// Permutation of the variables.
+        std::array<uint8_t, 6> permutation{};
+    };
+
+    /*!
+    * \brief Thread-safe memo table of exact NPN canonization results.
+    *
+    * Functions are keyed by raw 6-variable truth tables. Functions of the
+    * first four variables are kept in a 65536-entry array indexed by the
+    * low 16 bits of the table, other functions are kept in a sharded map.
+    * The cache may be saved to a file and loaded in the next runs.
+    */
+    class NPNCache {
+    public:
+        /*!
+        * \param shardsNumber Number of independently locked parts of the map.
+        */
+        explicit NPNCache(size_t shardsNumber = 64);
+
+        NPNCache(const NPNCache &) = delete;
+        NPNCache &operator=(const NPNCache &) = delete;
+
+        /*!
+        * \brief Returns the NPN representative of the function.
+        *
+        * The function is canonized on the first request only.
+        * \param table Raw 6-variable truth table.
+        */
+        NPNTransform canonize(uint64_t table);
+
+        size_t hits() const { return nHits.load(std::memory_order_relaxed); }
+
+        size_t misses() const {
+            return nMisses.load(std::memory_order_relaxed);
+        }
+
+        /// Share of the requests served without canonization.
+        double hitRate() const;
+
+        /// Number of the cached functions.
+        size_t size() const;
+
+        void clear();
+
+        /*!
+        * \brief Writes the cached functions to the binary file.
+        * \return False if the file cannot be written.
+        */
+        bool save(const std::string &path) const;
+
+        /*!
+        * \brief Adds the functions from the file written by save().
+        * \return False if the file cannot be read, has a wrong format or
+        * is shorter than its header says (nothing is added then).
+        */
+        bool load(const std::string &path);
+
+        /// Checks whether the function depends on the first 4 variables only.
+        static bool isSmallFunction(uint64_t table);
+
+    private:
+        // Transform is packed into a word, the highest bit marks
+        // the filled entries.
+        static constexpr uint64_t FILLED = 1ull << 63;
+
+        struct SmallEntry {
+            std::atomic<uint64_t> canonical{0};
+            std::atomic<uint64_t> transform{0};
+        };
+
+        struct Shard {
+            mutable std::mutex mutex;
+            std::unordered_map<uint64_t, NPNTransform> entries;
+        };
+
+        static NPNTransform compute(uint64_t table);
+
+        static uint64_t pack(const NPNTransform &transform);
+
+        static NPNTransform unpack(uint64_t canonical, uint64_t packed);
+
+        Shard &getShard(uint64_t table) const;
+
+        void insert(uint64_t table, const NPNTransform &transform);
+
+        std::unique_ptr<SmallEntry[]> small;
+        std::atomic<size_t> nSmall{0};
+        std::unique_ptr<Shard[]> shards;
+        size_t shardsNumber;
+        std::atomic<size_t> nHits{0};
+        std::atomic<size_t> nMisses{0};
+    };
+
+} // namespace eda::gate::optimizer
@@ -7,111 +7,234 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "gate/optimizer/cone_view.h"
+#include "gate/optimizer/cut_truth_table.h"
 #include "gate/optimizer/npn/npn_collector.h"
+#include "gate/optimizer/parallel_cuts_finder.h"
+#include "gate/optimizer/thread_pool.h"
 
-namespace eda::gate::optimizer {
-
-    void calculateAverageAndDeviation(const std::vector<NPNStats> &stats, SumStruct &sumStruct) {
-        assert(!stats.empty());
-        double sumMax = 0.0;
-        double sumMin = 0.0;
-        int n = static_cast<int>(stats.size());
+#include <algorithm>
 
-        // Calculate the sum of the elements.
-        for (const auto &data: stats) {
-            sumMax += data.maxHeight;
-            sumMin += data.minHeight;
-        }
+namespace eda::gate::optimizer {
 
-        // Calculate the mean.
-        double meanMax = sumMax / n;
-        double meanMin = sumMin / n;
+    void RunningStats::add(double value) {
+        ++n;
+        double delta = value - mean;
+        mean += delta / n;
+        m2 += delta * (value - mean);
+    }
 
-        sumStruct.maxHeightA = meanMax;
-        sumStruct.minHeightA = meanMin;
+    double RunningStats::deviation() const {
+        return n ? std::sqrt(m2 / n) : 0.0;
+    }
 
-        // Calculate the squared differences from the mean.
-        double squaredDiffSumMax = 0.0;
-        double squaredDiffSumMin = 0.0;
-        for (const auto &data: stats) {
-            squaredDiffSumMax += (data.maxHeight - meanMax) * (data.maxHeight - meanMax);
-            squaredDiffSumMin += (data.minHeight - meanMin) * (data.minHeight - meanMin);
-        }
+    // Every thread reuses the buffers of its builder.
+    static ConeViewBuilder &getConeViewBuilder() {
+        thread_local ConeViewBuilder builder;
+        return builder;
+    }
 
-        // Calculate the standard deviation.
-        sumStruct.minHeightD = std::sqrt(squaredDiffSumMin / n);
-        sumStruct.maxHeightD = std::sqrt(squaredDiffSumMax / n);
+    bool NPNCollector::classifyCut(const Cut &cut, GateId gateId, NPNStats &stats) {
+        return fillNPNStats(cut, cut.size(), gateId, stats);
     }
 
     bool
     NPNCollector::fillNPNStats(const Cut &cut, size_t cutSize, GateId gateId, NPNStats &toFill) {
-        ConeVisitor coneVisitor(cut, gateId);
-        Walker walker(net, &coneVisitor);
-        walker.walk(cut, gateId, false);
-
-        // Make binding.
-        BoundGNet boundGNet;
+        if (!cut.hasTruthTable()) {
+            return fillNPNStatsByCone(cut, cutSize, gateId, toFill);
+        }
 
-        const auto &cutConeMap = coneVisitor.getResultMatch();
-        const auto &resultCut = coneVisitor.getResultCutOldGates();
+        const uint64_t table = cut.truthTable();
+        if (collectHeight) {
+            getConeViewBuilder().build(gateId, cut).getHeights(
+                toFill.maxHeight, toFill.minHeight);
+        }
+        toFill.npnClass = truthTableToNPN(table)._bits;
+        toFill.cut = cut;
+        return true;
+    }
 
-        if (cut.size() != resultCut.size()) {
-            delete coneVisitor.getGNet();
+    bool
+    NPNCollector::fillNPNStatsByCone(const Cut &cut, size_t cutSize, GateId gateId, NPNStats &toFill) {
+        ConeView view = getConeViewBuilder().build(gateId, cut);
+        if (!view.isComplete()) {
             return false;
         }
         if (collectHeight) {
-            getHeights(gateId, toFill.maxHeight, toFill.minHeight, cut);
+            view.getHeights(toFill.maxHeight, toFill.minHeight);
         }
-        for (const auto &gate: resultCut) {
-            boundGNet.inputBindings.push_back(cutConeMap.find(gate)->second);
-        }
-        boundGNet.net = std::shared_ptr<GNet>(coneVisitor.getGNet());
-        TruthTable table = TruthTable::build(boundGNet);
-        auto npnClass = truthTableToNPN(table);
 
-        toFill.npnClass = npnClass._bits;
+        // The cone net is built only if the cone cannot be simulated.
+        // It is not kept after the table is computed.
+        uint64_t table;
+        if (!view.getTruthTable(table)) {
+            Order order(cut.begin(), cut.end());
+            table = TruthTable::build(view.materialize(order, nullptr)).raw();
+        }
+        toFill.npnClass = truthTableToNPN(table)._bits;
         toFill.cut = cut;
         return true;
     }
 
     kitty::static_truth_table<6>
     NPNCollector::truthTableToNPN(const TruthTable &table) {
-        kitty::static_truth_table<6> kt;
-        kt._bits = table.raw();
-
-        const auto [tt, inputNegations, outputNegation] = kitty::exact_npn_canonization(
-                kt);
+        return truthTableToNPN(table.raw());
+    }
 
+    kitty::static_truth_table<6>
+    NPNCollector::truthTableToNPN(uint64_t table) {
+        kitty::static_truth_table<6> tt;
+        tt._bits = npnCache->canonize(table).canonical;
         return tt;
     }
 
     void NPNCollector::addNPNStat(const GateId &gateId, const NPNStats &stat) {
         auto &gateStat = gateStatsMap[gateId];
-        gateStat.npnClassInfo.push_back(stat);
+        if (records) {
+            gateStat.npnClassInfo.push_back(stat);
+        }
         ++gateStat.numberOfCuts;
         SumStruct &data = npnStatistics[stat.npnClass];
-        data.count.emplace_back(stat);
+        ++data.count;
+        data.maxHeight.add(stat.maxHeight);
+        data.minHeight.add(stat.minHeight);
+        if (data.samples.size() < samplesNumber) {
+            data.samples.emplace_back(gateId, stat.cut);
+        }
     }
 
-    void NPNCollector::process(size_t cutSize, size_t maxCutsNumber) {
-        CutStorage storage = findCuts(net, cutSize, maxCutsNumber, false);
+    void NPNCollector::usePriorityCuts(CutCost *cost, size_t cutsNumber) {
+        priorityCost = cost;
+        priorityCutsNumber = cutsNumber;
+    }
 
-        std::cout << "Cuts found" << std::endl;
+    void NPNCollector::useNPNCache(std::shared_ptr<NPNCache> cache) {
+        npnCache = std::move(cache);
+    }
+
+    void NPNCollector::useConeArena(std::shared_ptr<ConeArena> arena) {
+        coneArena = arena ? std::move(arena) : std::make_shared<ConeArena>();
+    }
+
+    CutStorage NPNCollector::findProcessedCuts(size_t threadsNumber) const {
+        // Truth tables are computed with the cuts, so the cones are built
+        // only for the cuts with unsupported gates.
+        ParallelCutsFinder finder(processedCutSize, processedMaxCutsNumber,
+                                  priorityCost, threadsNumber);
+        finder.setTruthTables(true);
+        return finder.find(net);
+    }
 
-        for (auto &[gateId, cs]: storage.cuts) {
-            for (const auto &c: cs) {
-                if (c.size() != cutSize) {
+    // Gates are handled in the order of identifiers, so the statistics
+    // do not depend on the number of threads.
+    static std::vector<std::pair<GateId, const CutStorage::Cuts *>>
+    sortGates(const CutStorage &storage) {
+        std::vector<std::pair<GateId, const CutStorage::Cuts *>> gates;
+        gates.reserve(storage.cuts.size());
+        for (const auto &[gateId, cs]: storage.cuts) {
+            gates.emplace_back(gateId, &cs);
+        }
+        std::sort(gates.begin(), gates.end());
+        return gates;
+    }
+
+    void NPNCollector::sampleCuts(
+            std::unordered_map<uint64_t, std::vector<std::pair<GateId, Cut>>> &samples,
+            size_t number, size_t threadsNumber) {
+        // The cuts are found and classified again in the order of process(),
+        // so the kept samples are the first ones of the new ones.
+        std::cout << "Sampling the cuts of " << samples.size()
+                  << " NPN classes again" << std::endl;
+        for (auto &[npnClass, classSamples]: samples) {
+            classSamples.clear();
+        }
+        size_t remaining = samples.size();
+        CutStorage storage = findProcessedCuts(threadsNumber);
+        for (const auto &[gateId, cs]: sortGates(storage)) {
+            for (const auto &c: *cs) {
+                if (c.size() != processedCutSize) {
                     continue;
                 }
                 NPNStats npnStats;
-                if (fillNPNStats(c, cutSize, gateId, npnStats)) {
-                    addNPNStat(gateId, npnStats);
+                if (!fillNPNStats(c, processedCutSize, gateId, npnStats)) {
+                    continue;
+                }
+                auto found = samples.find(npnStats.npnClass);
+                if (found == samples.end() || found->second.size() == number) {
+                    continue;
+                }
+                found->second.emplace_back(gateId, c);
+                if (found->second.size() == number && --remaining == 0) {
+                    return;
+                }
+            }
+        }
+    }
+
+    void NPNCollector::process(size_t cutSize, size_t maxCutsNumber,
+                               size_t threadsNumber) {
+        // ALL_CUTS (zero) does not bound the number of cuts.
+        if (priorityCost && priorityCutsNumber != CutsFindVisitor::ALL_CUTS) {
+            maxCutsNumber = maxCutsNumber == CutsFindVisitor::ALL_CUTS
+                ? priorityCutsNumber
+                : std::min(maxCutsNumber, priorityCutsNumber);
+        }
+
+        processedCutSize = cutSize;
+        processedMaxCutsNumber = maxCutsNumber;
+        CutStorage storage = findProcessedCuts(threadsNumber);
+
+        std::cout << "Cuts found" << std::endl;
+
+        const auto gates = sortGates(storage);
+
+        // Each chunk of gates has its own shard of the statistics.
+        // The cuts without truth tables need cones, which are added to the
+        // global gate storage, so they are handled when shards are merged.
+        struct ShardEntry {
+            GateId gateId;
+            NPNStats npnStats;
+            bool pending;
+        };
+        const size_t chunkSize = 256;
+        const size_t chunksNumber = (gates.size() + chunkSize - 1) / chunkSize;
+        std::vector<std::vector<ShardEntry>> shards(chunksNumber);
+
+        ThreadPool pool(threadsNumber);
+        pool.parallelFor(chunksNumber, [&](size_t chunk, size_t) {
+            const size_t last = std::min(gates.size(), (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < last; ++i) {
+                const auto [gateId, cs] = gates[i];
+                for (const auto &c: *cs) {
+                    if (c.size() != cutSize) {
+                        continue;
+                    }
+                    NPNStats npnStats;
+                    if (!c.hasTruthTable()) {
+                        npnStats.cut = c;
+                        shards[chunk].push_back({gateId, npnStats, true});
+                    } else if (fillNPNStats(c, cutSize, gateId, npnStats)) {
+                        shards[chunk].push_back({gateId, npnStats, false});
+                    }
+                }
+            }
+        });
+
+        for (auto &shard: shards) {
+            for (auto &entry: shard) {
+                if (!entry.pending ||
+                    fillNPNStats(entry.npnStats.cut, cutSize, entry.gateId,
+                                 entry.npnStats)) {
+                    addNPNStat(entry.gateId, entry.npnStats);
                 }
             }
         }
 
         for (auto &[npn, stats]: npnStatistics) {
-            calculateAverageAndDeviation(stats.count, stats);
+            stats.maxHeightA = stats.maxHeight.mean;
+            stats.maxHeightD = stats.maxHeight.deviation();
+            stats.minHeightA = stats.minHeight.mean;
+            stats.minHeightD = stats.minHeight.deviation();
         }
     }
 
@@ -137,42 +260,93 @@ namespace eda::gate::optimizer {
     void NPNCollector::printHistogramData(std::ostream &stream) const {
         stream << "NPN Class;Count;MaxHeightA;MaxHeightD;MinHeightA;MinHeightD\n";
         for (const auto &[npnClass, data]: npnStatistics) {
-            stream << npnClass << ";" << data.count.size() << ";" << data.maxHeightA << ";" << data.maxHeightD << ";"
+            stream << npnClass << ";" << data.count << ";" << data.maxHeightA << ";" << data.maxHeightD << ";"
                    << data.minHeightA << ";" << data.minHeightD << "\n";
         }
     }
 
     std::unordered_map<uint64_t, std::vector<std::shared_ptr<GNet>>>
-    NPNCollector::getEssentialCones(int topNumber, int conesNumber) const {
+    NPNCollector::getEssentialCones(int topNumber, int conesNumber,
+                                    size_t threadsNumber) {
         // Selecting first topNumber NPN classes.
         topNumber = std::min(topNumber, static_cast<int>(npnStatistics.size()));
-        std::vector<std::pair<uint64_t, SumStruct>> popularNPN;
+        std::vector<std::pair<uint64_t, size_t>> popularNPN;
         popularNPN.reserve(npnStatistics.size());
-        for (const auto &pair: npnStatistics) {
-            popularNPN.emplace_back(pair);
+        for (const auto &[npnClass, data]: npnStatistics) {
+            popularNPN.emplace_back(npnClass, data.count);
         }
         std::partial_sort(popularNPN.begin(), popularNPN.begin() + topNumber,
                           popularNPN.end(),
-                          [](const std::pair<uint64_t, SumStruct> &a,
-                             const std::pair<uint64_t, SumStruct> &b) {
-                              return a.second.count.size() > b.second.count.size(); // Sort in descending order
+                          [](const std::pair<uint64_t, size_t> &a,
+                             const std::pair<uint64_t, size_t> &b) {
+                              return a.second > b.second; // Sort in descending order
                           });
 
-        std::unordered_map<uint64_t, std::vector<std::shared_ptr<GNet>>> rez;
+        conesNumber = std::max(conesNumber, 0);
+        const size_t number = conesNumber;
+        std::unordered_map<uint64_t, std::vector<std::pair<GateId, Cut>>> cuts;
         for (int i = 0; i < topNumber; ++i) {
-            rez.insert({popularNPN[i].first, {}});
-        }
-        for (const auto &[gate, gateStat]: gateStatsMap) {
-            for (const auto &npnStat: gateStat.npnClassInfo) {
-                auto found = rez.find(npnStat.npnClass);
-                if (found != rez.end() &&
-                    static_cast<int>(found->second.size()) < conesNumber) {
-                    Order order;
-                    order.insert(order.end(), npnStat.cut.begin(), npnStat.cut.end());
-                    auto binding = extractCone(net, gate, npnStat.cut, order);
-                    found->second.push_back(binding.net);
+            cuts[popularNPN[i].first];
+        }
+
+        if (records) {
+            // Every classified cut is recorded.
+            std::vector<GateId> gates;
+            gates.reserve(gateStatsMap.size());
+            for (const auto &[gateId, stats]: gateStatsMap) {
+                gates.push_back(gateId);
+            }
+            std::sort(gates.begin(), gates.end());
+            for (GateId gateId: gates) {
+                for (const auto &stat: gateStatsMap.at(gateId).npnClassInfo) {
+                    auto found = cuts.find(stat.npnClass);
+                    if (found != cuts.end() && found->second.size() < number) {
+                        found->second.emplace_back(gateId, stat.cut);
+                    }
                 }
             }
+        } else {
+            // The samples of process() are used if there are enough of them.
+            std::unordered_map<uint64_t, std::vector<std::pair<GateId, Cut>>> missing;
+            for (auto &[npnClass, classCuts]: cuts) {
+                const auto &data = npnStatistics.at(npnClass);
+                if (data.samples.size() < std::min(number, data.count)) {
+                    missing[npnClass];
+                } else {
+                    classCuts = data.samples;
+                    classCuts.resize(std::min(number, classCuts.size()));
+                }
+            }
+            if (!missing.empty()) {
+                sampleCuts(missing, number, threadsNumber);
+                for (auto &[npnClass, classCuts]: missing) {
+                    npnStatistics.at(npnClass).samples = classCuts;
+                    cuts[npnClass] = std::move(classCuts);
+                }
+            }
+        }
+
+        // All the cones are extracted at once.
+        std::vector<ConeRequest> requests;
+        std::vector<uint64_t> requestClasses;
+        for (int i = 0; i < topNumber; ++i) {
+            for (const auto &[gate, cut]: cuts[popularNPN[i].first]) {
+                requests.push_back({gate, cut, Order(cut.begin(), cut.end())});
+                requestClasses.push_back(popularNPN[i].first);
+            }
+        }
+        // The cones of every call form their own generation: the ones
+        // returned earlier are destroyed when they are not referenced.
+        coneArena->release();
+        auto bindings = extractCones(net, requests, threadsNumber, nullptr,
+                                     coneArena.get());
+
+        std::unordered_map<uint64_t, std::vector<std::shared_ptr<GNet>>> rez;
+        for (int i = 0; i < topNumber; ++i) {
+            rez[popularNPN[i].first];
+        }
+        for (size_t i = 0; i < bindings.size(); ++i) {
+            rez[requestClasses[i]].push_back(bindings[i].net);
         }
         return rez;
     }
@@ -6,6 +6,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "gate/optimizer/cone_arena.h"
+#include "gate/optimizer/cut_cost.h"
+#include "gate/optimizer/npn/npn_cache.h"
 #include "gate/optimizer/optimizer.h"
 #include "gate/optimizer/truthtable.h"
 #include "gate/optimizer/util.h"
@@ -13,12 +16,13 @@
 #include <kitty/npn.hpp>
 
 #include <cmath>
+#include <memory>
 
 namespace eda::gate::optimizer {
 
   struct NPNStats {
-    uint64_t npnClass;
-    int minHeight, maxHeight; // TODO add max and min height.
+    uint64_t npnClass = 0;
+    int minHeight = 0, maxHeight = 0; // TODO add max and min height.
     Cut cut;
   };
 
@@ -28,8 +32,21 @@ namespace eda::gate::optimizer {
     std::vector<NPNStats> npnClassInfo;
   };
 
+  // Online mean and standard deviation (Welford's algorithm).
+  struct RunningStats {
+    size_t n = 0;
+    double mean = 0.0, m2 = 0.0;
+
+    void add(double value);
+
+    double deviation() const;
+  };
+
   struct SumStruct {
-    std::vector<NPNStats> count;
+    size_t count = 0;
+    RunningStats maxHeight, minHeight;
+    // First cuts of the class kept for getEssentialCones().
+    std::vector<std::pair<GateId, Cut>> samples;
     double maxHeightA = -1, maxHeightD = -1, minHeightA = -1, minHeightD = -1;
   };
 
@@ -37,21 +54,118 @@ namespace eda::gate::optimizer {
   class NPNCollector {
   private:
     bool collectHeight = false;
+    bool records = false;
+    size_t samplesNumber = 10;
     GNet *net;
+    CutCost *priorityCost = nullptr;
+    size_t priorityCutsNumber = 0;
+    size_t processedCutSize = 0;
+    size_t processedMaxCutsNumber = 0;
+    std::shared_ptr<NPNCache> npnCache = std::make_shared<NPNCache>();
+    std::shared_ptr<ConeArena> coneArena = std::make_shared<ConeArena>();
     std::unordered_map<GateId, GateStats> gateStatsMap;
     std::unordered_map<uint64_t, SumStruct> npnStatistics;
 
     bool fillNPNStats(const Cut &cut, size_t cutSize, GateId gateId,
                       NPNStats &npnStats);
 
+    bool fillNPNStatsByCone(const Cut &cut, size_t cutSize, GateId gateId,
+                            NPNStats &npnStats);
+
+    CutStorage findProcessedCuts(size_t threadsNumber) const;
+
+    // Collects the first cuts of the classes like process() does.
+    void sampleCuts(
+        std::unordered_map<uint64_t, std::vector<std::pair<GateId, Cut>>> &samples,
+        size_t number, size_t threadsNumber);
+
     kitty::static_truth_table<6> truthTableToNPN(const TruthTable &table);
 
+    kitty::static_truth_table<6> truthTableToNPN(uint64_t table);
+
   public:
     explicit NPNCollector(GNet *_net) : net(_net) {}
 
     void addNPNStat(const GateId &gateId, const NPNStats &stat);
 
-    void process(size_t cutSize, size_t maxCutsNumber);
+    /*!
+    * \brief Makes the collector keep the statistics of every classified cut.
+    *
+    * The records are printed by printGateStatistics(). Otherwise only
+    * the per-gate cut numbers and the per-class aggregates are kept.
+    */
+    void keepRecords(bool enabled) { records = enabled; }
+
+    /*!
+    * \brief Sets the number of cuts kept for each NPN class.
+    *
+    * The cones returned by getEssentialCones() are built from the samples
+    * if there are enough of them.
+    */
+    void setSamplesNumber(size_t number) { samplesNumber = number; }
+
+    /*!
+    * \brief Makes process() keep the best cuts of each node only.
+    *
+    * \param cost Cost the cuts are ranked by (nullptr to find all cuts).
+    * \param cutsNumber Number of nontrivial cuts kept for a node
+    * (CutsFindVisitor::ALL_CUTS to keep all of them). It also bounds
+    * the maxCutsNumber passed to process().
+    */
+    void usePriorityCuts(CutCost *cost, size_t cutsNumber);
+
+    /*!
+    * \brief Sets the cache of NPN classes.
+    *
+    * The cache may be shared by several collectors and saved between runs.
+    */
+    void useNPNCache(std::shared_ptr<NPNCache> cache);
+
+    const NPNCache &getNPNCache() const { return *npnCache; }
+
+    /*!
+    * \brief Sets the arena the cones returned by getEssentialCones() are
+    * created in (null resets the default arena).
+    *
+    * Every getEssentialCones() call releases the arena and creates its
+    * cones in a new generation, which stays valid while any of them is
+    * referenced. The nets built while the cuts are classified are not
+    * created in the arena.
+    */
+    void useConeArena(std::shared_ptr<ConeArena> arena);
+
+    const ConeArena &getConeArena() const { return *coneArena; }
+
+    /*!
+    * \brief Returns the aggregated statistics of the NPN classes found
+    * by the last process() call.
+    */
+    const std::unordered_map<uint64_t, SumStruct> &getNPNStatistics() const {
+        return npnStatistics;
+    }
+
+    /*!
+    * \brief Classifies the cut of the gate.
+    *
+    * The truth table carried by the cut is used if it is computed,
+    * otherwise the table is computed from the cone of the cut. Both ways
+    * give the same class. The cut is skipped (false is returned) only if
+    * its cone is structurally incomplete.
+    */
+    bool classifyCut(const Cut &cut, GateId gateId, NPNStats &stats);
+
+    /*!
+    * \brief Finds the cuts of the net and collects their NPN classes.
+    *
+    * The cuts are classified by classifyCut().
+    *
+    * \param cutSize Number of leaves of the classified cuts.
+    * \param maxCutsNumber Maximum number of cuts for a single node.
+    * \param threadsNumber Number of threads (0 means hardware threads).
+    * The statistics do not depend on the number of threads.
+    */
+    void process(size_t cutSize, size_t maxCutsNumber,
+                 size_t threadsNumber = 1);
 
     void printGateStatistics(std::ostream &stream) const;
 
@@ -61,15 +175,22 @@ namespace eda::gate::optimizer {
     * \brief Retrieves the top NPN classes and their associated cones up to a specified number.
     *
     * This function first identifies the most popular NPN classes based on their statistics.
-    * It then iterates over the gate statistics map to find all cones associated with each of these popular NPN classes.
-    * The number of cones collected for each NPN class is limited by the conesNumber parameter.
+    * It then builds the cones of the first conesNumber cuts of each of these classes.
+    * The cuts are taken from the records if they are kept (see keepRecords()), otherwise
+    * from the samples of process() (see setSamplesNumber()). If there are fewer samples
+    * than requested, the cuts of the net are found and classified again, and the new
+    * samples are kept. The cones returned by the previous call are released from the
+    * cone arena (they are destroyed when they are not referenced).
     *
     * \param topNumber The number of top NPN classes to consider.
     * \param conesNumber The maximum number of cones to collect for each NPN class.
+    * \param threadsNumber The number of threads tracing the cones (0 means
+    * the number of hardware threads).
     * \return A map where each key is an NPN class and each value is a vector of shared pointers to the associated GNet objects.
     */
     std::unordered_map<uint64_t, std::vector<std::shared_ptr<GNet>>>
-    getEssentialCones(int topNumber, int conesNumber) const;
+    getEssentialCones(int topNumber, int conesNumber,
+                      size_t threadsNumber = 1);
   };
 
 } // namespace eda::gate::optimizer
\ No newline at end of file
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/parallel_cuts_finder.h"
+
+#include <stdexcept>
+
+namespace eda::gate::optimizer {
+
+  using Gate = model::Gate;
+
+  // Number of nodes taken by a thread at once.
+  constexpr size_t GRAIN = 16;
+
+  ParallelCutsFinder::ParallelCutsFinder(unsigned int cutSize,
+                                         unsigned int maxCutsNumber,
+                                         CutCost *cost, size_t threadsNumber) :
+      cutSize(cutSize), maxCutsNumber(maxCutsNumber), cost(cost),
+      pool(threadsNumber) {
+    if (cutSize > CutStorage::MAX_CUT_SIZE) {
+      throw std::invalid_argument("Too big cut size");
+    }
+  }
+
+  std::vector<ParallelCutsFinder::Level>
+  ParallelCutsFinder::levelize(Levelization &levelization,
+                               CutStorage &storage) const {
+    const auto &levels = levelization.getLevels();
+    storage.cuts.reserve(levelization.getOrder().size());
+
+    std::vector<Level> result(levels.size());
+    for (size_t level = 0; level < levels.size(); ++level) {
+      for (GateId node: levels[level]) {
+        Gate *gate = Gate::get(node);
+        if (gate->func() == model::GateSymbol::NOT) {
+          continue;
+        }
+
+        // All the cut sets are created here, so the storage map is not
+        // modified while the cuts are found concurrently.
+        NodeCuts nodeCuts{node, &storage.cuts[node], {}};
+        nodeCuts.inputCuts.reserve(gate->inputs().size());
+        for (const auto &input: gate->inputs()) {
+          GateId gateIdInput = input.node();
+          Gate *gateInput = Gate::get(gateIdInput);
+          if (gateInput->func() == model::GateSymbol::NOT) {
+            gateIdInput = gateInput->inputs().begin()->node();
+          }
+          nodeCuts.inputCuts.push_back(&storage.cuts[gateIdInput]);
+        }
+        result[level].push_back(std::move(nodeCuts));
+      }
+    }
+    return result;
+  }
+
+  CutStorage ParallelCutsFinder::find(const GNet *net) {
+    Levelization levelization(net);
+    return find(net, levelization);
+  }
+
+  CutStorage ParallelCutsFinder::find(const GNet *net,
+                                      Levelization &levelization) {
+    CutStorage storage;
+    if (cost) {
+      cost->prepare(*net);
+    }
+
+    auto levels = levelize(levelization, storage);
+    CutsFindVisitor finder(cutSize, &storage, maxCutsNumber, cost);
+    finder.setTruthTables(truthTables);
+
+    // Cuts are collected in a per-thread buffer and then copied to the
+    // node set, so the node set is allocated once with the exact size.
+    std::vector<Cuts> buffers(pool.size());
+
+    for (const auto &level: levels) {
+      pool.parallelFor(level.size(), [&](size_t i, size_t thread) {
+        const auto &nodeCuts = level[i];
+        auto &buffer = buffers[thread];
+        buffer.clear();
+        finder.findNodeCuts(nodeCuts.node, nodeCuts.inputCuts, buffer);
+        *nodeCuts.cuts = buffer;
+      }, GRAIN);
+    }
+    return storage;
+  }
+
+  CutStorage findCutsParallel(const model::GNet *net, unsigned int cutSize,
+                              unsigned int maxCutsNumber,
+                              size_t threadsNumber) {
+    ParallelCutsFinder finder(cutSize, maxCutsNumber, nullptr, threadsNumber);
+    return finder.find(net);
+  }
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+#include "gate/optimizer/cut_cost.h"
+#include "gate/optimizer/cut_storage.h"
+#include "gate/optimizer/cuts_finder_visitor.h"
+#include "gate/optimizer/levelization.h"
+#include "gate/optimizer/thread_pool.h"
+
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Finds cuts of the net nodes in several threads.
+  * \ Nodes are grouped by logic levels. The fanins of a node belong to the
+  * \ lower levels, so the cuts of all nodes of a level are found
+  * \ concurrently. The result is the same as the one of CutsFindVisitor.
+  */
+  class ParallelCutsFinder {
+
+  public:
+    using GNet = model::GNet;
+    using GateId = GNet::GateId;
+    using Cuts = CutStorage::Cuts;
+
+    /**
+     * @param cutSize Max number of nodes in a cut
+     * (not greater than CutStorage::MAX_CUT_SIZE).
+     * @param maxCutsNumber Maximum number of cuts for a single node.
+     * To avoid restriction CutsFindVisitor::ALL_CUTS can be used.
+     * @param cost Cost for the priority cuts (nullptr to find all cuts).
+     * @param threadsNumber Number of threads (0 means hardware threads).
+     * @throws std::invalid_argument if the cut size is too big.
+     */
+    ParallelCutsFinder(unsigned int cutSize,
+                       unsigned int maxCutsNumber = CutsFindVisitor::ALL_CUTS,
+                       CutCost *cost = nullptr, size_t threadsNumber = 0);
+
+    /// Enables computing the truth tables of the found cuts.
+    void setTruthTables(bool enabled) { truthTables = enabled; }
+
+    /**
+     * Finds the cuts of all nodes of the net.
+     */
+    CutStorage find(const GNet *net);
+
+    /**
+     * Finds the cuts of all nodes of the net using its cached levels
+     * (they are stale if the net was edited after the last invalidate()).
+     */
+    CutStorage find(const GNet *net, Levelization &levelization);
+
+  private:
+    /// Node with the pointers to its cut set and the fanin cut sets.
+    struct NodeCuts {
+      GateId node;
+      Cuts *cuts;
+      std::vector<const Cuts *> inputCuts;
+    };
+
+    using Level = std::vector<NodeCuts>;
+
+    std::vector<Level> levelize(Levelization &levelization,
+                                CutStorage &storage) const;
+
+    unsigned int cutSize;
+    unsigned int maxCutsNumber;
+    CutCost *cost;
+    bool truthTables = false;
+    ThreadPool pool;
+  };
+
+  /**
+   * \brief Finds cuts of the net nodes in several threads.
+   * @param net Net where cuts are found.
+   * @param cutSize Max number of nodes in a cut.
+   * @param maxCutsNumber Maximum number of cuts for a single node.
+   * @param threadsNumber Number of threads (0 means hardware threads).
+   * @return Found cuts (the same as ones found by a sequential walk).
+   */
+  CutStorage findCutsParallel(const model::GNet *net, unsigned int cutSize,
+                              unsigned int maxCutsNumber =
+                                  CutsFindVisitor::ALL_CUTS,
+                              size_t threadsNumber = 0);
+
+} // namespace eda::gate::optimizer
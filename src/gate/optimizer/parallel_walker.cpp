@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/parallel_walker.h"
+
+#include <thread>
+
+namespace eda::gate::optimizer {
+
+  ParallelWalker::ParallelWalker(const GNet *gNet, Visitor *visitor,
+                                 size_t threadsNumber) :
+      gNet(gNet), visitor(visitor), pool(threadsNumber) {}
+
+  void ParallelWalker::walk(bool forward, const CsrGraph *graph) {
+    std::unique_ptr<CsrGraph> snapshot;
+    if (!graph) {
+      snapshot = std::make_unique<CsrGraph>(*gNet);
+      graph = snapshot.get();
+    }
+    this->graph = graph;
+    this->forward = forward;
+
+    const size_t size = graph->size();
+    if (size == 0) {
+      return;
+    }
+
+    queuesNumber = visitor->isReentrant() ? pool.size() : 1;
+    queues = std::make_unique<ReadyQueue[]>(queuesNumber);
+    pending = std::make_unique<std::atomic<uint32_t>[]>(size);
+
+    // The source nodes are spread over the threads.
+    size_t queue = 0;
+    for (Index i = 0; i < size; ++i) {
+      const auto count = graph->next(i, !forward).size();
+      pending[i].store(count, std::memory_order_relaxed);
+      if (count == 0) {
+        queues[queue].nodes.push_back(i);
+        queue = (queue + 1) % queuesNumber;
+      }
+    }
+    remaining = size;
+    working = 0;
+    stopped = false;
+    steals = 0;
+
+    if (queuesNumber == 1) {
+      run(0);
+    } else {
+      pool.parallelFor(queuesNumber, [this](size_t queue, size_t) {
+        run(queue);
+      });
+    }
+
+    queues.reset();
+    pending.reset();
+    this->graph = nullptr;
+  }
+
+  void ParallelWalker::run(size_t queue) {
+    Index node;
+    while (remaining.load(std::memory_order_acquire) != 0 &&
+           !stopped.load(std::memory_order_relaxed)) {
+      if (!pop(queue, node)) {
+        if (isStarved()) {
+          stopped = true;
+          return;
+        }
+        // The other threads are handling the nodes this one waits for.
+        std::this_thread::yield();
+        continue;
+      }
+
+      const GateId id = graph->gateId(node);
+      auto flag = visitor->onNodeBegin(id);
+      if (flag == CONTINUE) {
+        flag = visitor->onNodeEnd(id);
+      }
+      if (flag == FINISH_ALL_NODES) {
+        stopped = true;
+        return;
+      }
+
+      // The last handled predecessor makes the node ready.
+      for (auto next: graph->next(node, forward)) {
+        if (pending[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          push(queue, next);
+        }
+      }
+      remaining.fetch_sub(1, std::memory_order_acq_rel);
+      working.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  }
+
+  bool ParallelWalker::isStarved() const {
+    // A node is taken and counted as working under the lock of its queue,
+    // and it is counted as handled before it stops working. So if no node
+    // is working and handled before and after all queues are found empty,
+    // no node can become ready (e.g. the rest of the nodes form a cycle).
+    const size_t before = remaining.load(std::memory_order_acquire);
+    if (working.load(std::memory_order_acquire) != 0) {
+      return false;
+    }
+    for (size_t i = 0; i < queuesNumber; ++i) {
+      std::lock_guard<std::mutex> lock(queues[i].mutex);
+      if (!queues[i].nodes.empty()) {
+        return false;
+      }
+    }
+    return working.load(std::memory_order_acquire) == 0 &&
+           remaining.load(std::memory_order_acquire) == before;
+  }
+
+  bool ParallelWalker::pop(size_t queue, Index &node) {
+    {
+      auto &own = queues[queue];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.nodes.empty()) {
+        node = own.nodes.back();
+        own.nodes.pop_back();
+        working.fetch_add(1, std::memory_order_acq_rel);
+        return true;
+      }
+    }
+
+    for (size_t i = 1; i < queuesNumber; ++i) {
+      auto &other = queues[(queue + i) % queuesNumber];
+      std::lock_guard<std::mutex> lock(other.mutex);
+      if (!other.nodes.empty()) {
+        node = other.nodes.front();
+        other.nodes.pop_front();
+        working.fetch_add(1, std::memory_order_acq_rel);
+        steals.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void ParallelWalker::push(size_t queue, Index node) {
+    auto &own = queues[queue];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    own.nodes.push_back(node);
+  }
+
+} // namespace eda::gate::optimizer
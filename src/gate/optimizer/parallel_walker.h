@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+#include "gate/optimizer/csr_graph.h"
+#include "gate/optimizer/thread_pool.h"
+#include "gate/optimizer/visitor.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Walker handling independent nodes of a net concurrently.
+  * \ A node is handled as soon as all its predecessors are handled (the
+  * \ fanins for the forward walk and the fanouts for the backward one).
+  * \ Ready nodes are kept in per-thread deques: a thread takes the nodes
+  * \ it has made ready and steals the oldest ones from the other threads
+  * \ when its own deque is empty. The handlers of a visitor that is not
+  * \ reentrant are called by a single thread in the same dependency order.
+  */
+  class ParallelWalker {
+
+  public:
+    using GNet = model::GNet;
+    using GateId = GNet::GateId;
+
+    /**
+     * @param gNet Net to be traced.
+     * @param visitor Node handler.
+     * @param threadsNumber Number of threads
+     * (0 means the number of hardware threads).
+     */
+    ParallelWalker(const GNet *gNet, Visitor *visitor,
+                   size_t threadsNumber = 0);
+
+    /**
+     * Traces all nodes of the net and calls the handler on each node.
+     * Only FINISH_ALL_NODES is handled, other flags are the same as
+     * CONTINUE (like in Walker::walk(bool)). The walk stops if no node
+     * can become ready (the nodes on a cycle and after it are not handled,
+     * see getRemaining()).
+     * @param forward Direction to perform a trace in.
+     * @param graph Snapshot of the net (if null, a snapshot is built).
+     */
+    void walk(bool forward, const CsrGraph *graph = nullptr);
+
+    /**
+     * Returns the number of nodes taken from the other threads
+     * during the last walk.
+     */
+    size_t getSteals() const { return steals; }
+
+    /**
+     * Returns the number of nodes not handled by the last walk
+     * (it is not zero if the walk has been stopped by the visitor
+     * or has been starved).
+     */
+    size_t getRemaining() const { return remaining; }
+
+  private:
+    using Index = CsrGraph::Index;
+
+    // Deque of ready nodes of a thread.
+    struct alignas(64) ReadyQueue {
+      std::mutex mutex;
+      std::deque<Index> nodes;
+    };
+
+    void run(size_t queue);
+
+    bool isStarved() const;
+
+    bool pop(size_t queue, Index &node);
+
+    void push(size_t queue, Index node);
+
+    const GNet *gNet;
+    Visitor *visitor;
+    ThreadPool pool;
+
+    // State of the current walk.
+    const CsrGraph *graph = nullptr;
+    bool forward = true;
+    std::unique_ptr<std::atomic<uint32_t>[]> pending;
+    std::unique_ptr<ReadyQueue[]> queues;
+    size_t queuesNumber = 0;
+    std::atomic<size_t> remaining{0};
+    // Number of nodes taken from the queues and not handled yet.
+    std::atomic<size_t> working{0};
+    std::atomic<bool> stopped{false};
+    std::atomic<size_t> steals{0};
+  };
+
+} // namespace eda::gate::optimizer
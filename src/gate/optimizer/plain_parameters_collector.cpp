@@ -8,70 +8,55 @@
 
 #include "plain_parameters_collector.h"
 
+#include <algorithm>
+
 namespace eda::gate::optimizer {
 
-    PlainParametersCollector::PlainParametersCollector(GNet *_net) : net(_net) {}
+    using Gate = model::Gate;
+    using GateId = model::GNet::GateId;
 
-    void PlainParametersCollector::collectInputs() {
-        parameters.numInputs = net->nSourceLinks();
-    }
+    PlainParametersCollector::PlainParametersCollector(
+            GNet *_net, Levelization *_levelization) :
+            net(_net), levelization(_levelization) {}
 
-    void PlainParametersCollector::collectOutputs() {
-        parameters.numOutputs = net->nTargetLinks();
-    }
+    void PlainParametersCollector::collect() {
+        Levelization local(net);
+        const auto &order = (levelization ? *levelization : local).getOrder();
 
-    void PlainParametersCollector::collectGates() {
+        parameters.numInputs = net->nSourceLinks();
+        parameters.numOutputs = net->nTargetLinks();
         parameters.numGates = net->nGates();
-    }
-
-    void PlainParametersCollector::collectAndGates() {
         parameters.numAnds = 0;
-        for (const auto &link : net->gates()) {
+        parameters.numInvertedEdges = 0;
+        parameters.longestPath = 0;
+
+        // The depths are indexed by the identifiers offset by the minimal
+        // one (like in CsrGraph). Gates out of the net are marked with -1.
+        const auto [minIt, maxIt] =
+            std::minmax_element(order.begin(), order.end());
+        const GateId minId = order.empty() ? 0 : *minIt;
+        depths.assign(order.empty() ? 0 : *maxIt - minId + 1, -1);
+
+        for (GateId gate : order) {
+            const Gate *link = Gate::get(gate);
             if (link->isAnd()) {
                 parameters.numAnds++;
             }
-        }
-    }
-
-    void PlainParametersCollector::collectInvertedEdges() {
-        parameters.numInvertedEdges = 0;
-        for (const auto &link : net->gates()) {
             if (link->isNot()) {
                 parameters.numInvertedEdges++;
             }
-        }
-    }
-
-    void PlainParametersCollector::findLongestPath() {
-        std::unordered_map<Gate::Id, int> distances;
-
-        for (const auto &gate : net->gates()) {
-            distances[gate->id()] = 0;
-        }
 
-        auto updateDistance = [&](const Gate::Id &from, const Gate::Id &to) {
-            distances[to] = std::max(distances[to], distances[from] + 1);
-        };
-
-        for (const auto &gate : net->gates()) {
-            for (const auto &input : gate->inputs()) {
-                updateDistance(input.node(), gate->id());
+            int depth = 0;
+            for (const auto &input : link->inputs()) {
+                const GateId fanin = input.node();
+                if (fanin >= minId && fanin - minId < depths.size() &&
+                        depths[fanin - minId] >= 0) {
+                    depth = std::max(depth, depths[fanin - minId] + 1);
+                }
             }
+            depths[gate - minId] = depth;
+            parameters.longestPath = std::max(parameters.longestPath, depth);
         }
-
-        parameters.longestPath = 0;
-        for (const auto &[gateId, distance] : distances) {
-            parameters.longestPath = std::max(parameters.longestPath, distance);
-        }
-    }
-
-    void PlainParametersCollector::collect() {
-        collectInputs();
-        collectOutputs();
-        collectGates();
-        collectAndGates();
-        collectInvertedEdges();
-        findLongestPath();
     }
 
     void PlainParametersCollector::printParameters(std::ostream &stream) const {
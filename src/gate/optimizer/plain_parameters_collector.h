@@ -10,11 +10,13 @@
 
 #include "gate/model/gnet.h"
 #include "gate/model/gate.h"
+#include "gate/optimizer/levelization.h"
 #include "util.h"
 
 #include <unordered_map>
 #include <iostream>
 #include <algorithm>
+#include <vector>
 
 namespace eda::gate::optimizer {
 
@@ -32,23 +34,26 @@ namespace eda::gate::optimizer {
     class PlainParametersCollector {
     private:
         GNet *net;
+        Levelization *levelization;
         PlainParameters parameters;
 
-        void collectInputs();
-
-        void collectOutputs();
-
-        void collectGates();
-
-        void collectAndGates();
-
-        void collectInvertedEdges();
-
-        void findLongestPath();
+        // Gate depths indexed by the gate identifiers offset by the minimal one.
+        std::vector<int> depths;
 
     public:
-        explicit PlainParametersCollector(GNet *_net);
-
+        /**
+         * @param _net Net the parameters are collected for.
+         * @param _levelization Cached levels of the net (if null, the levels
+         * are computed when the parameters are collected). Edits of the net
+         * are not tracked: call Levelization::invalidate() after them.
+         */
+        explicit PlainParametersCollector(GNet *_net,
+                                          Levelization *_levelization = nullptr);
+
+        /**
+         * Collects all the parameters in one pass over the gates
+         * in topological order.
+         */
         void collect();
 
         void printParameters(std::ostream &stream) const;
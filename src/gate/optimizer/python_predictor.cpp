@@ -0,0 +1,212 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/feature_extractor.h"
+#include "gate/optimizer/python_predictor.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace eda::gate::optimizer {
+
+  // Read-only view of a row-major float matrix, valid while the data are.
+  static PyObject *newMatrixView(const float *data, size_t rows,
+                                 size_t columns) {
+    Py_ssize_t shape[] = {static_cast<Py_ssize_t>(rows),
+                          static_cast<Py_ssize_t>(columns)};
+    Py_ssize_t strides[] = {static_cast<Py_ssize_t>(columns * sizeof(float)),
+                            sizeof(float)};
+    Py_buffer buffer{};
+    buffer.buf = const_cast<float*>(data);
+    buffer.len = rows * columns * sizeof(float);
+    buffer.itemsize = sizeof(float);
+    buffer.readonly = 1;
+    buffer.ndim = 2;
+    buffer.format = const_cast<char*>("f");
+    // The shape and the strides are copied by the memoryview.
+    buffer.shape = shape;
+    buffer.strides = strides;
+    return PyMemoryView_FromBuffer(&buffer);
+  }
+
+  // Reads the numbers from a buffer of doubles or floats or from a sequence.
+  static bool readQualities(PyObject *result, size_t size,
+                            std::vector<double> &qualities) {
+    qualities.resize(size);
+
+    Py_buffer view;
+    if (PyObject_CheckBuffer(result) &&
+        PyObject_GetBuffer(result, &view,
+                           PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) == 0) {
+      std::string format = view.format ? view.format : "B";
+      if (!format.empty() &&
+          (format[0] == '@' || format[0] == '=' || format[0] == '<')) {
+        format.erase(0, 1);
+      }
+      const bool isDouble = format == "d" && view.itemsize == sizeof(double);
+      const bool isFloat = format == "f" && view.itemsize == sizeof(float);
+      const bool matches = (isDouble || isFloat) &&
+          static_cast<size_t>(view.len / view.itemsize) == size;
+      if (matches && isDouble) {
+        const double *data = static_cast<const double*>(view.buf);
+        std::copy(data, data + size, qualities.begin());
+      } else if (matches) {
+        const float *data = static_cast<const float*>(view.buf);
+        std::copy(data, data + size, qualities.begin());
+      }
+      PyBuffer_Release(&view);
+      if (matches) {
+        return true;
+      }
+    }
+    PyErr_Clear();
+
+    PyObject *sequence = PySequence_Fast(result, "Result is not a sequence");
+    if (sequence == nullptr) {
+      PyErr_Print();
+      return false;
+    }
+    bool success =
+        static_cast<size_t>(PySequence_Fast_GET_SIZE(sequence)) == size;
+    PyObject **items = PySequence_Fast_ITEMS(sequence);
+    for (size_t i = 0; success && i < size; ++i) {
+      qualities[i] = PyFloat_AsDouble(items[i]);
+      if (PyErr_Occurred()) {
+        PyErr_Print();
+        success = false;
+      }
+    }
+    Py_DECREF(sequence);
+    if (!success) {
+      fprintf(stderr, "Unexpected result of \"predict_quality_batch\"\n");
+    }
+    return success;
+  }
+
+  PythonScenarioPredictor::PythonScenarioPredictor() {
+    Py_Initialize();
+  }
+
+  PythonScenarioPredictor::~PythonScenarioPredictor() {
+    Py_XDECREF(predictBatchFunction);
+    Py_XDECREF(predictFunction);
+    Py_XDECREF(predictorModule);
+    Py_Finalize();
+  }
+
+  bool PythonScenarioPredictor::loadPredictor() {
+    if (predictorLoaded) {
+      return predictorModule != nullptr;
+    }
+    predictorLoaded = true;
+
+    PyObject *pName = PyUnicode_DecodeFSDefault("synthesis_predictor");
+    predictorModule = PyImport_Import(pName);
+    Py_DECREF(pName);
+    if (predictorModule == nullptr) {
+      PyErr_Print();
+      fprintf(stderr, "Failed to load \"synthesis_predictor\"\n");
+      return false;
+    }
+
+    predictFunction =
+        PyObject_GetAttrString(predictorModule, "predict_quality");
+    if (!predictFunction || !PyCallable_Check(predictFunction)) {
+      Py_CLEAR(predictFunction);
+      PyErr_Clear();
+    }
+    predictBatchFunction =
+        PyObject_GetAttrString(predictorModule, "predict_quality_batch");
+    if (!predictBatchFunction || !PyCallable_Check(predictBatchFunction)) {
+      Py_CLEAR(predictBatchFunction);
+      PyErr_Clear();
+    }
+    return true;
+  }
+
+  bool PythonScenarioPredictor::predict(
+      const float *features, size_t rows, size_t columns,
+      const std::vector<std::string> &scenarios,
+      std::vector<double> &qualities) {
+    if (!loadPredictor()) {
+      return false;
+    }
+    if (predictBatchFunction &&
+        predictBatch(features, rows, columns, scenarios, qualities)) {
+      return true;
+    }
+    if (!predictFunction) {
+      fprintf(stderr, "Cannot find function \"predict_quality\"\n");
+      return false;
+    }
+    if (columns <= *std::max_element(std::begin(PLAIN_PARAMETER_COLUMNS),
+                                     std::end(PLAIN_PARAMETER_COLUMNS))) {
+      fprintf(stderr, "Too few features for \"predict_quality\"\n");
+      return false;
+    }
+
+    qualities.resize(rows * scenarios.size());
+    for (size_t row = 0; row < rows; ++row) {
+      for (size_t i = 0; i < scenarios.size(); ++i) {
+        qualities[row * scenarios.size() + i] =
+            predictQuality(features + row * columns, scenarios[i]);
+      }
+    }
+    return true;
+  }
+
+  bool PythonScenarioPredictor::predictBatch(
+      const float *features, size_t rows, size_t columns,
+      const std::vector<std::string> &scenarios,
+      std::vector<double> &qualities) {
+    PyObject *pFeatures = newMatrixView(features, rows, columns);
+    PyObject *pScenarios = PyList_New(scenarios.size());
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+      PyList_SET_ITEM(pScenarios, i, PyUnicode_FromString(scenarios[i].c_str()));
+    }
+
+    PyObject *pValue = PyObject_CallFunctionObjArgs(predictBatchFunction,
+                                                    pFeatures, pScenarios,
+                                                    nullptr);
+    Py_DECREF(pScenarios);
+    Py_DECREF(pFeatures);
+    if (pValue == nullptr) {
+      PyErr_Print();
+      fprintf(stderr, "Batch call failed\n");
+      return false;
+    }
+    bool success = readQualities(pValue, rows * scenarios.size(), qualities);
+    Py_DECREF(pValue);
+    return success;
+  }
+
+  double PythonScenarioPredictor::predictQuality(const float *row,
+                                                 const std::string &scenario) {
+    PyObject *pParameters = PyTuple_New(std::size(PLAIN_PARAMETER_COLUMNS));
+    for (size_t i = 0; i < std::size(PLAIN_PARAMETER_COLUMNS); ++i) {
+      PyTuple_SetItem(pParameters, i,
+                      PyLong_FromLong(static_cast<long>(
+                          row[PLAIN_PARAMETER_COLUMNS[i]])));
+    }
+    PyObject *pArgs = PyTuple_New(2);
+    PyTuple_SetItem(pArgs, 0, pParameters);
+    PyTuple_SetItem(pArgs, 1, Py_BuildValue("s", scenario.c_str()));
+
+    PyObject *pValue = PyObject_CallObject(predictFunction, pArgs);
+    Py_DECREF(pArgs);
+    if (pValue == nullptr) {
+      PyErr_Print();
+      fprintf(stderr, "Call failed\n");
+      return -1.0;
+    }
+    double result = PyFloat_AsDouble(pValue);
+    Py_DECREF(pValue);
+    return result;
+  }
+
+} // namespace eda::gate::optimizer
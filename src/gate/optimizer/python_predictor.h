@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/optimizer/scenario_predictor.h"
+
+#include <Python.h>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Scenario predictor calling the Python module synthesis_predictor.
+  * \ The interpreter is initialized by the constructor and finalized by
+  * \ the destructor, the module and its functions are imported once.
+  * \ If the module defines predict_quality_batch(features, scenarios),
+  * \ all the pairs are scored in one call: features is a read-only float32
+  * \ memoryview of shape (rows, columns) valid during the call, scenarios
+  * \ is a list of strings, and the result is a buffer or a sequence of
+  * \ rows * len(scenarios) numbers in row-major order. Otherwise (or if
+  * \ the call fails) predict_quality(parameters, scenario) is called for
+  * \ each pair with the tuple of the plain parameters taken from the row
+  * \ (inputs, outputs, ANDs, inverted edges and depth, see FeatureExtractor).
+  */
+  class PythonScenarioPredictor final : public ScenarioPredictor {
+
+  public:
+    PythonScenarioPredictor();
+    ~PythonScenarioPredictor() override;
+
+    PythonScenarioPredictor(const PythonScenarioPredictor &) = delete;
+    PythonScenarioPredictor &operator=(const PythonScenarioPredictor &) = delete;
+
+    bool predict(const float *features, size_t rows, size_t columns,
+                 const std::vector<std::string> &scenarios,
+                 std::vector<double> &qualities) override;
+
+  private:
+    bool loadPredictor();
+
+    bool predictBatch(const float *features, size_t rows, size_t columns,
+                      const std::vector<std::string> &scenarios,
+                      std::vector<double> &qualities);
+
+    double predictQuality(const float *row, const std::string &scenario);
+
+    // Handles cached for the predictor lifetime.
+    PyObject *predictorModule = nullptr;
+    PyObject *predictFunction = nullptr;
+    PyObject *predictBatchFunction = nullptr;
+    bool predictorLoaded = false;
+  };
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/scenario_batch_optimizer.h"
+#include "gate/optimizer/feature_extractor.h"
+#include "gate/optimizer/python_predictor.h"
+#include "gate/optimizer/synthesis_scenario_optimizer.h"
+#include "gate/optimizer/thread_pool.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+namespace eda::gate::optimizer {
+
+  using GNet = model::GNet;
+
+  // Parses the design by the file extension (nullptr if it cannot be).
+  static GNet *readDesign(const std::string &path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    if (!std::filesystem::exists(path)) {
+      return nullptr;
+    }
+    if (extension == ".graphml") {
+      return readGraphMLNet(path);
+    }
+    if (extension == ".v" || extension == ".sv") {
+      return readVerilogNet(path);
+    }
+    return nullptr;
+  }
+
+  ScenarioBatchOptimizer::ScenarioBatchOptimizer(
+      std::unique_ptr<ScenarioPredictor> predictor, size_t threadsNumber) :
+      predictor(std::move(predictor)), threadsNumber(threadsNumber) {}
+
+  void ScenarioBatchOptimizer::readManifest(const std::string &filename) {
+    const auto directory = std::filesystem::path(filename).parent_path();
+    std::ifstream infile(filename);
+    std::string line;
+    while (std::getline(infile, line)) {
+      const size_t begin = line.find_first_not_of(" \t\r");
+      if (begin == std::string::npos || line[begin] == '#') {
+        continue;
+      }
+      const size_t end = line.find_last_not_of(" \t\r");
+      std::filesystem::path path = line.substr(begin, end - begin + 1);
+      addDesign((path.is_relative() ? directory / path : path).string());
+    }
+  }
+
+  void ScenarioBatchOptimizer::addDesign(const std::string &path) {
+    Design design;
+    design.path = path;
+    designs.push_back(std::move(design));
+    collected = false;
+  }
+
+  void ScenarioBatchOptimizer::readSynthesisScenarios(
+      const std::string &filename) {
+    auto list = readScenarioList(filename);
+    scenarios.insert(scenarios.end(), list.begin(), list.end());
+  }
+
+  void ScenarioBatchOptimizer::collectFeatures() {
+    ThreadPool pool(threadsNumber);
+    std::vector<FeatureExtractor> extractors(pool.size());
+
+    std::vector<GNet*> nets;
+    for (size_t first = 0; first < designs.size(); first += chunkSize) {
+      const size_t count = std::min(chunkSize, designs.size() - first);
+
+      // The gates are created in the global storage by one thread.
+      nets.assign(count, nullptr);
+      for (size_t i = 0; i < count; ++i) {
+        nets[i] = readDesign(designs[first + i].path);
+        if (!nets[i]) {
+          fprintf(stderr, "Cannot parse \"%s\"\n",
+                  designs[first + i].path.c_str());
+        }
+      }
+
+      pool.parallelFor(count, [&](size_t i, size_t thread) {
+        if (nets[i]) {
+          designs[first + i].features = extractors[thread].extract(nets[i]);
+        }
+      });
+
+      for (GNet *net: nets) {
+        delete net;
+      }
+    }
+    collected = true;
+  }
+
+  void ScenarioBatchOptimizer::selectBestScenarios(size_t k) {
+    std::vector<size_t> parsed;
+    for (size_t i = 0; i < designs.size(); ++i) {
+      if (!designs[i].features.empty()) {
+        parsed.push_back(i);
+      }
+    }
+    if (parsed.empty()) {
+      return;
+    }
+
+    std::vector<std::string> steps;
+    steps.reserve(scenarios.size());
+    for (const auto &scenario: scenarios) {
+      steps.push_back(scenario.second);
+    }
+    const size_t width = designs[parsed.front()].features.size();
+    const size_t batches = (parsed.size() + batchSize - 1) / batchSize;
+    k = std::min(k, steps.size());
+
+    const bool parallel = predictor->isThreadSafe();
+    ThreadPool pool(parallel ? threadsNumber : 1);
+    std::vector<std::vector<float>> matrices(pool.size());
+    std::vector<std::vector<double>> qualities(pool.size());
+
+    pool.parallelFor(batches, [&](size_t batch, size_t thread) {
+      const size_t first = batch * batchSize;
+      const size_t count = std::min(batchSize, parsed.size() - first);
+      auto &matrix = matrices[thread];
+      auto &scores = qualities[thread];
+
+      matrix.resize(count * width);
+      for (size_t i = 0; i < count; ++i) {
+        const auto &features = designs[parsed[first + i]].features;
+        std::copy(features.begin(), features.end(), &matrix[i * width]);
+      }
+      if (!predictor->predict(matrix.data(), count, width, steps, scores)) {
+        scores.assign(count * steps.size(), -1.0);
+      }
+
+      std::vector<size_t> indices(steps.size());
+      for (size_t i = 0; i < count; ++i) {
+        const double *row = &scores[i * steps.size()];
+        std::iota(indices.begin(), indices.end(), 0);
+        std::partial_sort(indices.begin(), indices.begin() + k, indices.end(),
+                          [row](size_t a, size_t b) {
+                            return row[a] > row[b] ||
+                                   (row[a] == row[b] && a < b);
+                          });
+
+        Design &design = designs[parsed[first + i]];
+        design.best.assign(indices.begin(), indices.begin() + k);
+        design.qualities.clear();
+        for (size_t index: design.best) {
+          design.qualities.push_back(row[index]);
+        }
+      }
+    });
+  }
+
+  void ScenarioBatchOptimizer::evaluateAndSelectBestScenarios(
+      int k, const std::string &outputFile) {
+    if (!collected) {
+      collectFeatures();
+    }
+    if (!predictor) {
+      predictor = std::make_unique<PythonScenarioPredictor>();
+    }
+    selectBestScenarios(std::max(k, 0));
+
+    std::ofstream outfile(outputFile);
+    for (const auto &design: designs) {
+      if (design.features.empty()) {
+        continue;
+      }
+      outfile << "# " << design.path << "\n";
+      for (size_t index: design.best) {
+        outfile << scenarios[index].first << ": " << scenarios[index].second
+                << "\n";
+      }
+    }
+  }
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/optimizer/scenario_predictor.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Selects the best synthesis scenarios for many designs at once.
+  * \ The designs are listed in a manifest. They are parsed in chunks:
+  * \ the parsing is sequential (the gates are allocated in the global
+  * \ storage), the features of a chunk are extracted in parallel and
+  * \ the nets are deleted before the next chunk. All the designs are then
+  * \ scored in batches of feature rows, in parallel if the predictor is
+  * \ thread-safe, and the top scenarios of every design are written to
+  * \ one file.
+  */
+  class ScenarioBatchOptimizer {
+
+  public:
+    /// Design of the manifest.
+    struct Design {
+      std::string path;
+      // Empty if the design cannot be parsed.
+      std::vector<float> features;
+      // Indices of the best scenarios, the best first.
+      std::vector<size_t> best;
+      std::vector<double> qualities;
+    };
+
+    /**
+     * @param predictor Scenario predictor (if null, the Python one is
+     * created on the first evaluation).
+     * @param threadsNumber Number of threads (0 means hardware threads).
+     */
+    explicit ScenarioBatchOptimizer(
+        std::unique_ptr<ScenarioPredictor> predictor = nullptr,
+        size_t threadsNumber = 0);
+
+    /// Sets the number of the designs kept in memory at once.
+    void setChunkSize(size_t size) { chunkSize = size ? size : 1; }
+
+    /// Sets the number of the designs scored by a predictor call.
+    void setBatchSize(size_t size) { batchSize = size ? size : 1; }
+
+    /**
+     * Reads the manifest: a path to a GraphML (.graphml) or a Verilog
+     * (.v, .sv) design per line. The relative paths are resolved against
+     * the manifest directory, the empty lines and the lines starting
+     * with '#' are skipped.
+     */
+    void readManifest(const std::string &filename);
+
+    void addDesign(const std::string &path);
+
+    /// Reads the "name: steps" lines of the scenarios.
+    void readSynthesisScenarios(const std::string &filename);
+
+    /// Parses the designs and extracts their features.
+    void collectFeatures();
+
+    /**
+     * Scores the scenarios and writes the best ones of every design.
+     * The features are collected first if they have not been yet.
+     * @param k Number of the best scenarios of a design.
+     * @param outputFile File the designs ("# path" lines) followed by
+     * their best scenarios ("name: steps" lines) are written to.
+     */
+    void evaluateAndSelectBestScenarios(int k, const std::string &outputFile);
+
+    const std::vector<Design> &getDesigns() const { return designs; }
+
+  private:
+    void selectBestScenarios(size_t k);
+
+    std::unique_ptr<ScenarioPredictor> predictor;
+    const size_t threadsNumber;
+    size_t chunkSize = 32;
+    size_t batchSize = 16;
+    bool collected = false;
+
+    std::vector<Design> designs;
+    std::vector<std::pair<std::string, std::string>> scenarios;
+  };
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Interface of the models predicting the quality of synthesis
+  * \ scenarios from the features of the designs (see FeatureExtractor).
+  */
+  class ScenarioPredictor {
+
+  public:
+    virtual ~ScenarioPredictor() = default;
+
+    /**
+     * Scores every scenario for every feature row.
+     * @param features Row-major matrix of the feature rows.
+     * @param rows Number of the rows.
+     * @param columns Number of the features in a row.
+     * @param scenarios Steps of the scenarios.
+     * @param qualities Output row-major matrix of rows * scenarios.size()
+     * qualities (the higher the better).
+     * @return false if the scenarios cannot be scored.
+     */
+    virtual bool predict(const float *features, size_t rows, size_t columns,
+                         const std::vector<std::string> &scenarios,
+                         std::vector<double> &qualities) = 0;
+
+    /// Checks whether predict() may be called from several threads at once.
+    virtual bool isThreadSafe() const { return false; }
+  };
+
+} // namespace eda::gate::optimizer
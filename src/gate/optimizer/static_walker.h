@@ -0,0 +1,280 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "gate/model/gnet.h"
+#include "gate/optimizer/csr_graph.h"
+#include "gate/optimizer/cut_storage.h"
+#include "gate/optimizer/levelization.h"
+#include "gate/optimizer/visitor.h"
+#include "util/graph.h"
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+  /// Checks whether the visitor type handles cuts (like CutVisitor does).
+  template <typename V, typename = void>
+  struct HasOnCut : std::false_type {};
+
+  template <typename V>
+  struct HasOnCut<V, std::void_t<decltype(std::declval<V&>().onCut(
+      std::declval<const model::GNet::GateId&>(),
+      std::declval<const CutStorage::Cut&>()))>> : std::true_type {};
+
+  /**
+   * \brief Walker with the visitor type known at compile time.
+   * \ Provides the walks of Walker (and the cut walk of CutWalker) without
+   * \ virtual calls: the handlers of V are called directly, so the cheap
+   * \ ones are inlined into the traversal loop. V is a concrete class with
+   * \ onNodeBegin and onNodeEnd (and optionally onCut) methods, it is not
+   * \ required to be derived from Visitor.
+   * \ Cone walks are performed on a CsrGraph snapshot, so the visitor
+   * \ must not modify the net.
+   */
+  template <typename V>
+  class StaticWalker {
+
+  public:
+    using GNet = model::GNet;
+    using Gate = model::Gate;
+    using GateId = GNet::GateId;
+    using Cut = CutStorage::Cut;
+
+    /**
+     * @param gNet Net to be traced.
+     * @param visitor Node handler.
+     * @param graph Snapshot of the net used by the cone walks
+     * (if null, it is built on the first cone walk).
+     */
+    StaticWalker(const GNet *gNet, V *visitor,
+                 const CsrGraph *graph = nullptr) :
+        gNet(gNet), visitor(visitor), graph(graph) {}
+
+    /**
+     * Sets the cached topological order of the net used by walk(bool).
+     * The caller invalidates it after the net is edited.
+     */
+    void setLevelization(Levelization *levelization) {
+      this->levelization = levelization;
+    }
+
+    /**
+     * Sets the cuts passed to onCut for every handled node.
+     * It is used only if the visitor handles cuts.
+     */
+    void setCutStorage(const CutStorage *cutStorage) {
+      this->cutStorage = cutStorage;
+    }
+
+    /**
+     * Traces all nodes in topological order and calls the handler on each node.
+     * @param forward Direction to perform a trace in.
+     */
+    void walk(bool forward) {
+      if (levelization) {
+        // The cached order must be invalidated after the net is edited.
+        assert(levelization->checkOrder() && "Levelization is stale");
+        walk(levelization->getOrder(), forward);
+        return;
+      }
+      walk(utils::graph::topologicalSort(*gNet), forward);
+    }
+
+    /**
+     * Traces the nodes in the given order and calls the handler on each node.
+     * @param nodes Specific topological order of nodes to trace.
+     * @param forward Direction to perform a trace in.
+     */
+    void walk(const std::vector<GateId> &nodes, bool forward) {
+      const size_t size = nodes.size();
+      for (size_t i = 0; i < size; ++i) {
+        // Only FINISH_ALL_NODES, CONTINUE expected.
+        if (call(forward ? nodes[i] : nodes[size - 1 - i]) ==
+            FINISH_ALL_NODES) {
+          return;
+        }
+      }
+    }
+
+    /**
+     * Traces nodes from a cone in topological order from the cone vertex
+     * to the cone base (like Walker does).
+     * @param start Cone vertex.
+     * @param cut Cone base.
+     * @param forward Direction to perform a trace in.
+     */
+    void walk(GateId start, const DynamicCut &cut, bool forward) {
+      collectCone(start, &cut, forward);
+      walkRegion(forward);
+    }
+
+    /**
+     * Traces nodes from a cone in topological order from the cone base
+     * to the cone vertex (like Walker does).
+     * @param start Cone base.
+     * @param end Cone vertex.
+     * @param forward Direction to perform a trace in.
+     */
+    void walk(const DynamicCut &start, GateId end, bool forward) {
+      collectCone(end, &start, forward);
+      walkRegion(!forward);
+    }
+
+    /**
+     * Traces nodes from a cone with the sources of the net as the base.
+     * @param start Cone vertex.
+     * @param forward Direction to perform a trace in.
+     */
+    void walk(GateId start, bool forward) {
+      collectCone(start, nullptr, forward);
+      walkRegion(forward);
+    }
+
+  private:
+    using Index = CsrGraph::Index;
+
+    VisitorFlags call(GateId node) {
+      // The qualified calls are not virtual even if V overrides Visitor.
+      auto flag = visitor->V::onNodeBegin(node);
+      if (flag != CONTINUE) {
+        return flag;
+      }
+
+      if constexpr (HasOnCut<V>::value) {
+        if (cutStorage) {
+          auto found = cutStorage->cuts.find(node);
+          if (found != cutStorage->cuts.end()) {
+            for (const auto &cut: found->second) {
+              // Only CONTINUE, FINISH_ALL_NODES and SKIP are expected.
+              flag = visitor->V::onCut(node, cut);
+              if (flag == FINISH_ALL_NODES || flag == SKIP) {
+                return flag;
+              }
+            }
+          }
+        }
+      }
+
+      return visitor->V::onNodeEnd(node);
+    }
+
+    void prepare() {
+      if (!graph) {
+        snapshot = std::make_unique<CsrGraph>(*gNet);
+        graph = snapshot.get();
+      }
+      if (stamps.size() < graph->size()) {
+        stamps.resize(graph->size());
+        degrees.resize(graph->size());
+        reached.resize(graph->size());
+      }
+      region.clear();
+      queue.clear();
+      if (++epoch == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        epoch = 1;
+      }
+    }
+
+    void add(Index node) {
+      if (stamps[node] != epoch) {
+        stamps[node] = epoch;
+        degrees[node] = 0;
+        reached[node] = 0;
+        region.push_back(node);
+      }
+    }
+
+    void collectCone(GateId start, const DynamicCut *cut, bool forward) {
+      prepare();
+      assert(graph->indexOf(start) != CsrGraph::NO_INDEX &&
+             "Node is out of the snapshot");
+      add(graph->indexOf(start));
+      for (size_t i = 0; i < region.size(); ++i) {
+        Index cur = region[i];
+        if (cut && cut->find(graph->gateId(cur)) != cut->end()) {
+          continue;
+        }
+        for (auto next: graph->next(cur, forward)) {
+          add(next);
+        }
+      }
+    }
+
+    // Visits the collected nodes when all their predecessors are visited.
+    void walkRegion(bool forward) {
+      for (auto node: region) {
+        for (auto prev: graph->next(node, !forward)) {
+          degrees[node] += stamps[prev] == epoch;
+        }
+      }
+      for (auto node: region) {
+        if (degrees[node] == 0) {
+          reached[node] = 1;
+          queue.push_back(node);
+        }
+      }
+
+      for (size_t i = 0; i < queue.size(); ++i) {
+        Index cur = queue[i];
+
+        // The nodes reached only through the nodes which finished further
+        // nodes are not visited.
+        bool propagate = false;
+        if (reached[cur]) {
+          switch (call(graph->gateId(cur))) {
+            case FINISH_ALL_NODES:
+              return;
+            case FINISH_FURTHER_NODES:
+              break;
+            case CONTINUE:
+            case SKIP:
+              propagate = true;
+              break;
+            default:
+              std::cerr << "Unexpected flag in StaticWalker." << std::endl;
+              return;
+          }
+        }
+
+        for (auto node: graph->next(cur, forward)) {
+          if (stamps[node] != epoch) {
+            continue;
+          }
+          reached[node] |= propagate;
+          if (--degrees[node] == 0) {
+            queue.push_back(node);
+          }
+        }
+      }
+    }
+
+    const GNet *gNet;
+    V *visitor;
+    const CsrGraph *graph;
+    std::unique_ptr<CsrGraph> snapshot;
+    Levelization *levelization = nullptr;
+    const CutStorage *cutStorage = nullptr;
+
+    // State of the cone walks (entries stamped with the current epoch).
+    std::vector<uint32_t> stamps;
+    std::vector<uint32_t> degrees;
+    std::vector<uint8_t> reached;
+    uint32_t epoch = 0;
+    std::vector<Index> region;
+    std::vector<Index> queue;
+  };
+
+} // namespace eda::gate::optimizer
@@ -7,57 +7,100 @@
 //===----------------------------------------------------------------------===//
 
 #include "synthesis_scenario_optimizer.h"
+#include "gate/optimizer/python_predictor.h"
 
+#include <cassert>
 
 namespace eda::gate::optimizer {
 
-    SynthesisScenarioOptimizer::SynthesisScenarioOptimizer()
-            : net(nullptr) {
-        initializePython();
-    }
+    SynthesisScenarioOptimizer::SynthesisScenarioOptimizer(
+            std::unique_ptr<ScenarioPredictor> predictor)
+            : net(nullptr), predictor(std::move(predictor)) {}
 
     SynthesisScenarioOptimizer::~SynthesisScenarioOptimizer() {
         delete net;
-        finalizePython();
     }
 
-    void SynthesisScenarioOptimizer::readGraphML(const std::string &filename) {
+    void SynthesisScenarioOptimizer::setPredictor(
+            std::unique_ptr<ScenarioPredictor> predictor) {
+        this->predictor = std::move(predictor);
+    }
+
+    model::GNet *readGraphMLNet(const std::string &filename) {
         parser::graphml::GraphMLParser::ParserData data;
-        net = parser::graphml::GraphMLParser::parse(filename, data);
+        return parser::graphml::GraphMLParser::parse(filename, data);
     }
 
-    void SynthesisScenarioOptimizer::readVerilog(const std::string &filename) {
+    model::GNet *readVerilogNet(const std::string &filename) {
         eda::gate::parser::verilog::GateVerilogParser parser(filename);
         lorina::text_diagnostics consumer;
         lorina::diagnostic_engine diag(&consumer);
         lorina::return_code result = read_verilog(filename, parser, &diag);
-        assert(result == lorina::return_code::success);
-        net = parser.getGnet();
+        return result == lorina::return_code::success ? parser.getGnet() : nullptr;
     }
 
-    void SynthesisScenarioOptimizer::collectParameters() {
-        PlainParametersCollector collector(net);
-        collector.collect();
-        parameters = collector.getParameters();
-    }
-
-    void SynthesisScenarioOptimizer::readSynthesisScenarios(const std::string &filename) {
+    std::vector<std::pair<std::string, std::string>>
+    readScenarioList(const std::string &filename) {
+        std::vector<std::pair<std::string, std::string>> list;
         std::ifstream infile(filename);
         std::string line;
         while (std::getline(infile, line)) {
             std::istringstream iss(line);
             std::string name, steps;
             if (std::getline(iss, name, ':') && std::getline(iss, steps)) {
-                scenarios[name] = steps;
+                list.emplace_back(name, steps);
             }
         }
+        return list;
+    }
+
+    void SynthesisScenarioOptimizer::readGraphML(const std::string &filename) {
+        net = readGraphMLNet(filename);
+        features.clear();
+    }
+
+    void SynthesisScenarioOptimizer::readVerilog(const std::string &filename) {
+        net = readVerilogNet(filename);
+        assert(net != nullptr);
+        features.clear();
+    }
+
+    void SynthesisScenarioOptimizer::collectParameters() {
+        assert(net != nullptr);
+        Levelization levelization(net);
+        features = extractor.extract(net, &levelization);
+    }
+
+    void SynthesisScenarioOptimizer::readSynthesisScenarios(const std::string &filename) {
+        for (auto &[name, steps]: readScenarioList(filename)) {
+            scenarios[name] = steps;
+        }
     }
 
     std::vector<std::pair<std::string, double>> SynthesisScenarioOptimizer::evaluateScenarios() {
+        std::vector<std::string> names, steps;
+        names.reserve(scenarios.size());
+        steps.reserve(scenarios.size());
+        for (const auto &[name, scenario]: scenarios) {
+            names.push_back(name);
+            steps.push_back(scenario);
+        }
+
+        if (features.empty()) {
+            collectParameters();
+        }
+        if (!predictor) {
+            predictor = std::make_unique<PythonScenarioPredictor>();
+        }
+        std::vector<double> qualities;
+        if (!predictor->predict(features.data(), 1, features.size(), steps, qualities)) {
+            qualities.assign(steps.size(), -1.0);
+        }
+
         std::vector<std::pair<std::string, double>> results;
-        for (const auto &[name, steps]: scenarios) {
-            double quality = predictScenarioQuality(steps);
-            results.emplace_back(name, quality);
+        results.reserve(names.size());
+        for (size_t i = 0; i < names.size(); ++i) {
+            results.emplace_back(names[i], qualities[i]);
         }
         return results;
     }
@@ -74,60 +117,4 @@ namespace eda::gate::optimizer {
         }
     }
 
-    void SynthesisScenarioOptimizer::initializePython() {
-        Py_Initialize();
-    }
-
-    void SynthesisScenarioOptimizer::finalizePython() {
-        Py_Finalize();
-    }
-
-    double SynthesisScenarioOptimizer::predictScenarioQuality(const std::string &scenario) {
-        PyObject *pName, *pModule, *pFunc;
-        PyObject *pArgs, *pValue;
-
-        pName = PyUnicode_DecodeFSDefault("synthesis_predictor");
-        pModule = PyImport_Import(pName);
-        Py_DECREF(pName);
-
-        if (pModule != nullptr) {
-            pFunc = PyObject_GetAttrString(pModule, "predict_quality");
-            if (pFunc && PyCallable_Check(pFunc)) {
-                pArgs = PyTuple_New(2);
-                PyTuple_SetItem(pArgs, 0, Py_BuildValue("(iiiii)",
-                                                        parameters.numInputs, parameters.numOutputs,
-                                                        parameters.numAnds,
-                                                        parameters.numInvertedEdges, parameters.longestPath));
-                PyTuple_SetItem(pArgs, 1, Py_BuildValue("s", scenario.c_str()));
-
-                pValue = PyObject_CallObject(pFunc, pArgs);
-                Py_DECREF(pArgs);
-                if (pValue != nullptr) {
-                    double result = PyFloat_AsDouble(pValue);
-                    Py_DECREF(pValue);
-                    Py_DECREF(pFunc);
-                    Py_DECREF(pModule);
-                    return result;
-                } else {
-                    Py_DECREF(pFunc);
-                    Py_DECREF(pModule);
-                    PyErr_Print();
-                    fprintf(stderr, "Call failed\n");
-                    return -1.0;
-                }
-            } else {
-                if (PyErr_Occurred())
-                    PyErr_Print();
-                fprintf(stderr, "Cannot find function \"predict_quality\"\n");
-            }
-            Py_XDECREF(pFunc);
-            Py_DECREF(pModule);
-        } else {
-            PyErr_Print();
-            fprintf(stderr, "Failed to load \"synthesis_predictor\"\n");
-            return -1.0;
-        }
-        return -1.0;
-    }
-
 } // namespace eda::gate::optimizer
@@ -11,39 +11,61 @@
 
 #include "gate/parser/gate_verilog.h"
 #include "gate/parser/graphml.h"
-#include "gate/optimizer/plain_parameters_collector.h"
+#include "gate/optimizer/feature_extractor.h"
+#include "gate/optimizer/scenario_predictor.h"
 
 #include <lorina/common.hpp>
 #include <lorina/diagnostics.hpp>
 #include <lorina/verilog.hpp>
 
-#include <Python.h>
 #include <fstream>
+#include <memory>
 #include <sstream>
 #include <algorithm>
 
 namespace eda::gate::optimizer {
 
+    /// Reads a net from a GraphML file (nullptr if it cannot be parsed).
+    eda::gate::model::GNet *readGraphMLNet(const std::string &filename);
+
+    /// Reads a net from a Verilog file (nullptr if it cannot be parsed).
+    eda::gate::model::GNet *readVerilogNet(const std::string &filename);
+
+    /// Reads the "name: steps" lines of a scenario file in the file order.
+    std::vector<std::pair<std::string, std::string>>
+    readScenarioList(const std::string &filename);
+
+    /**
+     * Selects the synthesis scenarios predicted to be the best for a net.
+     *
+     * The scenarios are scored in one call of the predictor. If no
+     * predictor is set, the Python one is created on the first evaluation
+     * (see PythonScenarioPredictor), so the interpreter is initialized
+     * only if it is used.
+     */
     class SynthesisScenarioOptimizer {
     public:
-        SynthesisScenarioOptimizer();
+        explicit SynthesisScenarioOptimizer(
+                std::unique_ptr<ScenarioPredictor> predictor = nullptr);
         ~SynthesisScenarioOptimizer();
 
+        void setPredictor(std::unique_ptr<ScenarioPredictor> predictor);
+
         void readGraphML(const std::string &filename);
         void readVerilog(const std::string &filename);
+        /// Extracts the features of the net (done lazily on evaluation).
         void collectParameters();
         void readSynthesisScenarios(const std::string &filename);
         void evaluateAndSelectBestScenarios(int k, const std::string &outputFile);
 
     private:
         eda::gate::model::GNet *net;
-        PlainParameters parameters;
+        FeatureExtractor extractor;
+        std::vector<float> features;
         std::unordered_map<std::string, std::string> scenarios;
-        std::vector<std::pair<std::string, double>> evaluateScenarios();
+        std::unique_ptr<ScenarioPredictor> predictor;
 
-        void initializePython();
-        void finalizePython();
-        double predictScenarioQuality(const std::string &scenario);
+        std::vector<std::pair<std::string, double>> evaluateScenarios();
     };
 
 } // namespace eda::gate::optimizer
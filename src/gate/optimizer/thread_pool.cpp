@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/thread_pool.h"
+
+#include <algorithm>
+
+namespace eda::gate::optimizer {
+
+  ThreadPool::ThreadPool(size_t threadsNumber) {
+    if (threadsNumber == 0) {
+      threadsNumber = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(threadsNumber - 1);
+    for (size_t i = 1; i < threadsNumber; ++i) {
+      workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopped = true;
+    }
+    wakeUp.notify_all();
+    for (auto &worker: workers) {
+      worker.join();
+    }
+  }
+
+  size_t ThreadPool::size() const {
+    return workers.size() + 1;
+  }
+
+  void ThreadPool::parallelFor(size_t count, const Task &task, size_t grain) {
+    if (count == 0) {
+      return;
+    }
+
+    // Small jobs are not worth waking the workers up.
+    if (workers.empty() || count <= grain) {
+      for (size_t i = 0; i < count; ++i) {
+        task(i, 0);
+      }
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      this->task = &task;
+      this->count = count;
+      this->grain = std::max<size_t>(1, grain);
+      next = 0;
+      busyWorkers = workers.size();
+      ++generation;
+    }
+    wakeUp.notify_all();
+
+    runChunks(0);
+
+    // The workers are waited for even if the task has thrown.
+    std::exception_ptr thrown;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      done.wait(lock, [this] { return busyWorkers == 0; });
+      this->task = nullptr;
+      std::swap(thrown, error);
+    }
+    if (thrown) {
+      std::rethrow_exception(thrown);
+    }
+  }
+
+  void ThreadPool::workerLoop(size_t thread) {
+    size_t seen = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wakeUp.wait(lock, [&] { return stopped || generation != seen; });
+        if (stopped) {
+          return;
+        }
+        seen = generation;
+      }
+
+      runChunks(thread);
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        --busyWorkers;
+      }
+      done.notify_one();
+    }
+  }
+
+  void ThreadPool::runChunks(size_t thread) {
+    try {
+      while (true) {
+        size_t first = next.fetch_add(grain);
+        if (first >= count) {
+          return;
+        }
+        size_t last = std::min(count, first + grain);
+        for (size_t i = first; i < last; ++i) {
+          (*task)(i, thread);
+        }
+      }
+    } catch (...) {
+      // The first exception is kept, the remaining chunks are skipped.
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+      next = count;
+    }
+  }
+
+} // namespace eda::gate::optimizer
@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eda::gate::optimizer {
+
+ /**
+  * \brief Pool of worker threads running index ranges in parallel.
+  * \ The calling thread takes part in the work as the thread number 0.
+  */
+  class ThreadPool {
+
+  public:
+    /// Function handling the index with the given thread number.
+    using Task = std::function<void(size_t index, size_t thread)>;
+
+    /**
+     * @param threadsNumber Number of threads including the calling one
+     * (0 means the number of hardware threads).
+     */
+    explicit ThreadPool(size_t threadsNumber = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * Returns the number of threads including the calling one.
+     */
+    size_t size() const;
+
+    /**
+     * Calls the task for all indices in [0, count) and waits for it.
+     * @param count Number of indices.
+     * @param task Index handler.
+     * @param grain Number of indices taken by a thread at once.
+     * @throws The first exception thrown by the task (on any thread).
+     * The remaining indices may be skipped then.
+     */
+    void parallelFor(size_t count, const Task &task, size_t grain = 1);
+
+  private:
+    void workerLoop(size_t thread);
+
+    void runChunks(size_t thread);
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable done;
+
+    // Current job.
+    const Task *task = nullptr;
+    size_t count = 0;
+    size_t grain = 1;
+    std::atomic<size_t> next{0};
+    size_t busyWorkers = 0;
+    size_t generation = 0;
+    std::exception_ptr error;
+    bool stopped = false;
+  };
+
+} // namespace eda::gate::optimizer
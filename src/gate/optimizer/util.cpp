@@ -7,7 +7,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "gate/optimizer/util.h"
+#include "gate/optimizer/cut_cost.h"
+#include "gate/optimizer/cuts_finder_visitor.h"
+#include "gate/optimizer/dominator_tree.h"
+#include "gate/optimizer/static_walker.h"
+#include "gate/optimizer/thread_pool.h"
 
+#include <algorithm>
 #include <queue>
 
 namespace eda::gate::optimizer {
@@ -30,7 +36,7 @@ namespace eda::gate::optimizer {
     return next;
   }
 
-  bool isCut(const GateId &gate, const Cut &cut, GateId &failed) {
+  bool isCut(const GateId &gate, const DynamicCut &cut, GateId &failed) {
     std::queue<GateId> bfs;
     bfs.push(gate);
     while (!bfs.empty()) {
@@ -49,101 +55,146 @@ namespace eda::gate::optimizer {
     return true;
   }
 
-  std::unordered_set<GateId>
-  intersect(std::unordered_map<GateId, std::unordered_set<GateId>> &dominators,
-            const std::vector<base::model::Signal<GateId>> &inputs) {
-
-    // Finding the least dominators set.
-    auto minIt = std::min_element(
-        inputs.begin(), inputs.end(), [&](const auto &a, const auto &b) {
-          return dominators[a.node()].size() < dominators[b.node()].size();
-        });
-
-    std::unordered_set<GateId> last = dominators[minIt->node()];
-
-    for (const auto &signal: inputs) {
-      if (last.empty()) {
-        break;
-      }
-      std::unordered_set<GateId> result;
-      if (signal == *minIt) {
-        continue;
-      }
-      const auto &set = dominators[signal.node()];
-      for (const GateId &elem: last) {
-        if (set.find(elem) != set.end()) {
-          result.emplace(elem);
-        }
-      }
-      last = std::move(result);
+  CutStorage findPriorityCuts(const GNet *net, unsigned int cutSize,
+                              unsigned int maxCutsNumber, CutCost &cost,
+                              Levelization *levelization) {
+    CutStorage cutStorage;
+    cost.prepare(*net);
+    CutsFindVisitor visitor(cutSize, &cutStorage, maxCutsNumber, &cost);
+    if (levelization) {
+      visitor.enumerate(levelization->getOrder());
+    } else {
+      visitor.enumerate(utils::graph::topologicalSort(*net));
     }
-    return last;
+    return cutStorage;
   }
 
   std::unordered_map<GateId, std::unordered_set<GateId>>
   findDominators(const std::vector<GateId> &topoOrder) {
     std::unordered_map<GateId, std::unordered_set<GateId>> dominators;
+    dominators.reserve(topoOrder.size());
 
-    for (unsigned int current: topoOrder) {
-      const auto &inputs = Gate::get(current)->inputs();
-
-      if (inputs.empty()) {
-        dominators[current] = {current};
-      } else {
-        auto newDom = intersect(dominators, Gate::get(current)->inputs());
-        auto &set = dominators[current] = std::move(newDom);
-        set.emplace(current);
-      }
+    DominatorTree tree(topoOrder);
+    for (GateId current: topoOrder) {
+      const auto chain = tree.getDominators(current);
+      dominators.emplace(current,
+                         std::unordered_set<GateId>(chain.begin(), chain.end()));
     }
 
     return dominators;
   }
 
-  void
-  getConeSet(GateId start, std::unordered_set<GateId> &cone, bool forward) {
-    std::queue<GateId> bfs;
-    bfs.push(start);
+  std::unordered_map<GateId, std::unordered_set<GateId>>
+  findDominators(Levelization &levelization) {
+    return findDominators(levelization.getOrder());
+  }
 
-    // First trace to define needed nodes.
-    while (!bfs.empty()) {
-      GateId cur = bfs.front();
-      bfs.pop();
-      cone.emplace(cur);
-      auto next = getNext(cur, forward);
-      for (auto node: next) {
-        bfs.push(node);
+  // Traces the cone in the breadth-first order: every node is added once.
+  static ConeStatus getConeSet(GateId start, const DynamicCut *cut,
+                               ConeSet &cone,
+                               bool forward, const ConeLimits &limits) {
+    ConeStatus status = CONE_COMPLETE;
+    std::vector<GateId> current{start};
+    std::vector<GateId> next;
+    cone.emplace(start);
+
+    for (size_t depth = 0; !current.empty(); ++depth) {
+      next.clear();
+      for (GateId cur: current) {
+        if (cut && cut->find(cur) != cut->end()) {
+          continue;
+        }
+        for (auto node: getNext(cur, forward)) {
+          if (cone.find(node) != cone.end()) {
+            continue;
+          }
+          if (depth >= limits.maxDepth) {
+            status = CONE_DEPTH_LIMIT;
+            continue;
+          }
+          if (cone.size() >= limits.maxNodes) {
+            return CONE_SIZE_LIMIT;
+          }
+          cone.emplace(node);
+          next.push_back(node);
+        }
       }
+      std::swap(current, next);
     }
+    return status;
   }
 
-  void getConeSet(GateId start, const Cut &cut,
-                  std::unordered_set<GateId> &coneNodes, bool forward) {
-    std::queue<GateId> bfs;
-    bfs.push(start);
+  void getConeSet(GateId start, ConeSet &cone, bool forward) {
+    getConeSet(start, nullptr, cone, forward, ConeLimits());
+  }
 
-    // First trace to define needed nodes.
-    while (!bfs.empty()) {
-      GateId cur = bfs.front();
-      bfs.pop();
-      coneNodes.emplace(cur);
-      if (cut.find(cur) != cut.end()) {
+  void getConeSet(GateId start, const DynamicCut &cut, ConeSet &cone,
+                  bool forward) {
+    getConeSet(start, &cut, cone, forward, ConeLimits());
+  }
+
+  ConeStatus getConeSet(GateId start, ConeSet &cone, bool forward,
+                        const ConeLimits &limits) {
+    return getConeSet(start, nullptr, cone, forward, limits);
+  }
+
+  ConeStatus getConeSet(GateId start, const DynamicCut &cut, ConeSet &cone,
+                        bool forward, const ConeLimits &limits) {
+    return getConeSet(start, &cut, cone, forward, limits);
+  }
+
+  // Traces the cone over the snapshot: every node is added once.
+  static void getConeSet(const CsrGraph &graph, GateId start,
+                         const DynamicCut *cut, ConeSet &cone,
+                         bool forward) {
+    std::vector<bool> visited(graph.size());
+    std::vector<CsrGraph::Index> stack;
+
+    CsrGraph::Index startIndex = graph.indexOf(start);
+    assert(startIndex != CsrGraph::NO_INDEX && "Node is out of the snapshot");
+    visited[startIndex] = true;
+    stack.push_back(startIndex);
+    while (!stack.empty()) {
+      CsrGraph::Index cur = stack.back();
+      stack.pop_back();
+      GateId curId = graph.gateId(cur);
+      cone.emplace(curId);
+      if (cut && cut->find(curId) != cut->end()) {
         continue;
       }
-      auto next = getNext(cur, forward);
-      for (auto node: next) {
-        bfs.push(node);
+      for (auto next: graph.next(cur, forward)) {
+        if (!visited[next]) {
+          visited[next] = true;
+          stack.push_back(next);
+        }
       }
     }
   }
 
-  BoundGNet extractCone(const GNet *net, GateId root, const Cut &cut,
-                        const Order &order) {
-    ConeVisitor coneVisitor(cut, root);
-    Walker walker(net, &coneVisitor);
+  void getConeSet(const CsrGraph &graph, GateId start, ConeSet &cone,
+                  bool forward) {
+    getConeSet(graph, start, nullptr, cone, forward);
+  }
+
+  void getConeSet(const CsrGraph &graph, GateId start, const DynamicCut &cut,
+                  ConeSet &cone, bool forward) {
+    getConeSet(graph, start, &cut, cone, forward);
+  }
+
+  // The nets created in an arena share the arena control block.
+  static std::shared_ptr<GNet> shareConeNet(GNet *net, ConeArena *arena) {
+    return arena ? arena->share(net) : std::shared_ptr<GNet>(net);
+  }
+
+  BoundGNet extractCone(const GNet *net, GateId root, const DynamicCut &cut,
+                        const Order &order, const CsrGraph *graph,
+                        ConeArena *arena) {
+    ConeVisitor coneVisitor(cut, root, arena);
+    Walker walker(net, &coneVisitor, graph);
     walker.walk(cut, root, false);
 
     BoundGNet boundGNet;
-    boundGNet.net = std::shared_ptr<GNet>(coneVisitor.getGNet());
+    boundGNet.net = shareConeNet(coneVisitor.getGNet(), arena);
     const auto &cutConeMap = coneVisitor.getResultMatch();
     for (const auto &gate: order) {
       boundGNet.inputBindings.push_back(cutConeMap.find(gate)->second);
@@ -151,15 +202,16 @@ namespace eda::gate::optimizer {
     return boundGNet;
   }
 
-  BoundGNet extractCone(const GNet *net, GateId root, const Order &order) {
-    Cut cut(order.begin(), order.end());
+  BoundGNet extractCone(const GNet *net, GateId root, const Order &order,
+                        const CsrGraph *graph, ConeArena *arena) {
+    DynamicCut cut(order.begin(), order.end());
 
-    ConeVisitor coneVisitor(cut, root);
-    Walker walker(net, &coneVisitor);
+    ConeVisitor coneVisitor(cut, root, arena);
+    Walker walker(net, &coneVisitor, graph);
     walker.walk(cut, root, false);
 
     BoundGNet boundGNet;
-    boundGNet.net = std::shared_ptr<GNet>(coneVisitor.getGNet());
+    boundGNet.net = shareConeNet(coneVisitor.getGNet(), arena);
     const auto &cutConeMap = coneVisitor.getResultMatch();
     for (const auto &gate: order) {
       boundGNet.inputBindings.push_back(cutConeMap.find(gate)->second);
@@ -167,7 +219,100 @@ namespace eda::gate::optimizer {
     return boundGNet;
   }
 
-  void rmRecursive(GNet *net, GateId start) {
+  // Records the nodes of a cone in the walk order.
+  class ConeRecorder final : public Visitor {
+  public:
+    std::vector<GateId> *nodes = nullptr;
+
+    VisitorFlags onNodeBegin(const GateId &node) override {
+      nodes->push_back(node);
+      return CONTINUE;
+    }
+
+    VisitorFlags onNodeEnd(const GateId &) override {
+      return CONTINUE;
+    }
+  };
+
+  struct ConeKeyHash {
+    size_t operator()(const std::pair<GateId, DynamicCut> &key) const {
+      return std::hash<GateId>()(key.first) ^ (key.second.hash() << 1);
+    }
+  };
+
+  std::vector<BoundGNet> extractCones(const GNet *net,
+                                      const std::vector<ConeRequest> &requests,
+                                      size_t threadsNumber,
+                                      const CsrGraph *graph,
+                                      ConeArena *arena) {
+    // Identical cones are traced and built once.
+    std::unordered_map<std::pair<GateId, DynamicCut>, size_t, ConeKeyHash>
+        coneIds;
+    std::vector<size_t> requestCones(requests.size());
+    std::vector<size_t> firstRequests;
+    for (size_t i = 0; i < requests.size(); ++i) {
+      auto [it, added] = coneIds.emplace(
+          std::make_pair(requests[i].root, requests[i].cut),
+          firstRequests.size());
+      if (added) {
+        firstRequests.push_back(i);
+      }
+      requestCones[i] = it->second;
+    }
+
+    std::unique_ptr<CsrGraph> snapshot;
+    if (!graph) {
+      snapshot = std::make_unique<CsrGraph>(*net);
+      graph = snapshot.get();
+    }
+
+    // The walk state of a thread is reused for all its cones.
+    ThreadPool pool(threadsNumber);
+    std::vector<ConeRecorder> recorders(pool.size());
+    std::vector<std::unique_ptr<StaticWalker<ConeRecorder>>> walkers;
+    for (auto &recorder: recorders) {
+      walkers.push_back(std::make_unique<StaticWalker<ConeRecorder>>(
+          net, &recorder, graph));
+    }
+
+    std::vector<std::vector<GateId>> coneNodes(firstRequests.size());
+    pool.parallelFor(firstRequests.size(), [&](size_t cone, size_t thread) {
+      const auto &request = requests[firstRequests[cone]];
+      recorders[thread].nodes = &coneNodes[cone];
+      walkers[thread]->walk(request.cut, request.root, false);
+    });
+
+    // Nets are built by a single thread.
+    std::vector<BoundGNet> result(requests.size());
+    std::vector<std::vector<size_t>> coneRequests(firstRequests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+      coneRequests[requestCones[i]].push_back(i);
+    }
+    for (size_t cone = 0; cone < firstRequests.size(); ++cone) {
+      const auto &request = requests[firstRequests[cone]];
+      ConeVisitor coneVisitor(request.cut, request.root, arena);
+      for (GateId node: coneNodes[cone]) {
+        if (coneVisitor.onNodeBegin(node) == FINISH_ALL_NODES) {
+          break;
+        }
+      }
+      coneNodes[cone] = std::vector<GateId>();
+
+      auto coneNet = shareConeNet(coneVisitor.getGNet(), arena);
+      const auto &cutConeMap = coneVisitor.getResultMatch();
+      for (size_t i: coneRequests[cone]) {
+        auto &boundGNet = result[i];
+        boundGNet.net = coneNet;
+        for (const auto &gate: requests[i].order) {
+          boundGNet.inputBindings.push_back(cutConeMap.find(gate)->second);
+        }
+      }
+    }
+    return result;
+  }
+
+  void rmRecursive(GNet *net, GateId start, NetChanges *changes,
+                   Levelization *levelization) {
 
     std::vector<GateId> removed;
 
@@ -184,6 +329,9 @@ namespace eda::gate::optimizer {
         auto *next = Gate::get(out.target);
         if (next->isTarget()) {
           net->eraseGate(out.target);
+          if (changes) {
+            changes->removed.push_back(out.target);
+          }
         } else {
           auto inputs = next->inputs();
           auto foundId =
@@ -191,28 +339,32 @@ namespace eda::gate::optimizer {
                            [node](const auto &x) { return x.node() == node; });
           inputs.erase(foundId);
           net->setGate(out.target, next->func(), inputs);
+          if (changes) {
+            changes->modified.push_back(out.target);
+          }
         }
       }
       net->eraseGate(node);
+      if (changes) {
+        changes->removed.push_back(node);
+      }
     }
 
     // Erasing gates with zero fanout.
     for (auto gate: removed) {
       net->eraseGate(gate);
     }
-  }
-
-  bool isSubsetOf(const Cut &smaller, const Cut &bigger) {
-    for (const GateId &gateId: smaller) {
-      if (bigger.find(gateId) == bigger.end()) {
-        return false;
-      }
+    if (changes) {
+      changes->removed.insert(changes->removed.end(),
+                              removed.begin(), removed.end());
+    }
+    if (levelization) {
+      levelization->invalidate();
     }
-    return true;
   }
 
   void getHeights(GateId start, int &maxHeight, int &minHeight,
-                  const Cut &cut) {
+                  const DynamicCut &cut) {
     minHeight = std::numeric_limits<int>::max();
     maxHeight = -1;
     // Pair of gate ID and current height.
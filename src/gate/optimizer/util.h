@@ -10,11 +10,17 @@
 
 #include "gate/model/gnet.h"
 #include "gate/optimizer/bgnet.h"
+#include "gate/optimizer/cone_arena.h"
+#include "gate/optimizer/cone_limits.h"
 #include "gate/optimizer/cone_visitor.h"
+#include "gate/optimizer/csr_graph.h"
+#include "gate/optimizer/levelization.h"
 #include "gate/optimizer/links_clean_counter.h"
 #include "gate/optimizer/walker.h"
 
+#include <algorithm>
 #include <limits>
+#include <unordered_set>
 
 /**
  * \brief Methods for circuit model optimization.
@@ -29,6 +35,8 @@ namespace eda::gate::optimizer {
   using Cut = CutStorage::Cut;
   using Order = std::vector<GateId>;
 
+  class CutCost;
+
   //===--------------------------------------------------------------------===//
   // Model modification methods
   //===--------------------------------------------------------------------===//
@@ -41,12 +49,25 @@ namespace eda::gate::optimizer {
    */
   std::vector<GNet::GateId> getNext(GateId node, bool forward);
 
+  /**
+   * \brief Gates changed by an edit of a net.
+   */
+  struct NetChanges {
+    /// Gates which inputs have been changed or which have been added.
+    std::vector<GateId> modified;
+    /// Gates which have been erased from the net.
+    std::vector<GateId> removed;
+  };
+
   /**
    * \brief Removes the start node and others that were used only by the start.
    * @param net Net to delete nodes from.
    * @param start Node to start recursive deleting with.
+   * @param changes If not null, the modified and erased gates are added.
+   * @param levelization If not null, it is invalidated.
    */
-  void rmRecursive(GNet *net, GateId start);
+  void rmRecursive(GNet *net, GateId start, NetChanges *changes = nullptr,
+                   Levelization *levelization = nullptr);
 
   //===--------------------------------------------------------------------===//
   // Cut-related methods
@@ -55,15 +76,41 @@ namespace eda::gate::optimizer {
   /**
    * \brief Checks that a given cut is indeed a cut for a given vertex.
    */
-  bool isCut(const GateId &gate, const Cut &cut, GateId &failed);
+  bool isCut(const GateId &gate, const DynamicCut &cut, GateId &failed);
+
+  /**
+   * \brief Finds the priority cuts of the net nodes.
+   * For each node the trivial cut and maxCutsNumber nontrivial cuts
+   * of the lowest cost are kept.
+   * @param net Net where cuts are found.
+   * @param cutSize Max number of nodes in a cut.
+   * @param maxCutsNumber Number of nontrivial cuts kept for a node.
+   * @param cost Cost the cuts are ranked by.
+   * @param levelization Cached order of the net (if null, the net is sorted).
+   * It must be invalidated after the net is edited.
+   * @return Found cuts.
+   */
+  CutStorage findPriorityCuts(const GNet *net, unsigned int cutSize,
+                              unsigned int maxCutsNumber, CutCost &cost,
+                              Levelization *levelization = nullptr);
 
   /**
    * \brief Finds list of dominators for the topologically sorted nodes.
+   * The sets are taken from the dominator tree (see DominatorTree, which
+   * should be used directly for the dominance queries on big nets).
    * @return Map of a node and all its dominators in the net.
    */
   std::unordered_map<GateId, std::unordered_set<GateId>> findDominators(
       const std::vector<GateId> &topoOrder);
 
+  /**
+   * \brief Finds list of dominators for the nodes of the levelized net.
+   * The levelization must be up to date (see Levelization::invalidate()).
+   * @return Map of a node and all its dominators in the net.
+   */
+  std::unordered_map<GateId, std::unordered_set<GateId>> findDominators(
+      Levelization &levelization);
+
   //===--------------------------------------------------------------------===//
   // Cone-related methods
   //===--------------------------------------------------------------------===//
@@ -83,7 +130,56 @@ namespace eda::gate::optimizer {
    * @param coneNodes Set of nodes, that make up the cone will be stored.
    * @param forward Direction of building a cone.
    */
-  void getConeSet(GateId start, const Cut &cut, ConeSet &cone, bool forward);
+  void getConeSet(GateId start, const DynamicCut &cut, ConeSet &cone,
+                  bool forward);
+
+  /**
+   * \brief Finds the nodes of a bounded maximum cone for the node.
+   * The nodes are added in the breadth-first order, so the nearest nodes
+   * are found when the node budget is exceeded.
+   * @param start Vertex of the cone.
+   * @param cone Empty set where the nodes of the cone will be stored.
+   * @param forward Direction of building a cone.
+   * @param limits Bounds of the cone.
+   * @return Reason why the cone is not traced up to the net boundary.
+   */
+  ConeStatus getConeSet(GateId start, ConeSet &cone, bool forward,
+                        const ConeLimits &limits);
+
+  /**
+   * \brief Finds the nodes of a bounded cone for the node.
+   * @param start Vertex of the cone.
+   * @param cut Nodes that restricting the base of a cone.
+   * @param cone Empty set where the nodes of the cone will be stored.
+   * @param forward Direction of building a cone.
+   * @param limits Bounds of the cone.
+   * @return Reason why the cone is not traced up to the cut.
+   */
+  ConeStatus getConeSet(GateId start, const DynamicCut &cut, ConeSet &cone,
+                        bool forward, const ConeLimits &limits);
+
+  /**
+   * \brief Finds all nodes that are part of a maximum cone for the node.
+   * The neighbours of the nodes are taken from the net snapshot.
+   * @param graph Snapshot of the net.
+   * @param start Vertex of the cone.
+   * @param cone Set of nodes, that make up the cone will be stored.
+   * @param forward Direction of building a cone.
+   */
+  void getConeSet(const CsrGraph &graph, GateId start, ConeSet &cone,
+                  bool forward);
+
+  /**
+   * \brief Finds all nodes that are part of a cone for the node.
+   * The neighbours of the nodes are taken from the net snapshot.
+   * @param graph Snapshot of the net.
+   * @param start Vertex of the cone.
+   * @param cut Nodes that restricting the base of a cone.
+   * @param cone Set of nodes, that make up the cone will be stored.
+   * @param forward Direction of building a cone.
+   */
+  void getConeSet(const CsrGraph &graph, GateId start, const DynamicCut &cut,
+                  ConeSet &cone, bool forward);
 
   /**
    * \brief Cone extraction function.
@@ -91,24 +187,78 @@ namespace eda::gate::optimizer {
    * @param root Vertex for which the cone is constructed.
    * @param cut Cut that forms the cone.
    * @param order The order will be kept when constructing correspondence map.
+   * @param graph Snapshot of the net to be traced (may be null).
+   * @param arena Arena the cone net is created in (may be null).
    * @return Extracted cone with input correspondence map.
    */
   BoundGNet extractCone(const GNet *net,
                         GateId root,
-                        const Cut &cut,
-                        const Order &order);
+                        const DynamicCut &cut,
+                        const Order &order,
+                        const CsrGraph *graph = nullptr,
+                        ConeArena *arena = nullptr);
 
   /**
    * \brief Cone extraction function.
    * @param net Net where cone extraction is executed.
    * @param root Vertex for which the cone is constructed.
    * @param order The order will be kept when constructing correspondence map.
+   * @param graph Snapshot of the net to be traced (may be null).
+   * @param arena Arena the cone net is created in (may be null).
    * @return Extracted cone with input correspondence map.
    */
-  BoundGNet extractCone(const GNet *net, GateId root, const Order &order);
+  BoundGNet extractCone(const GNet *net, GateId root, const Order &order,
+                        const CsrGraph *graph = nullptr,
+                        ConeArena *arena = nullptr);
+
+  /**
+   * \brief Request of a cone extraction.
+   * @param root Vertex for which the cone is constructed.
+   * @param cut Cut that forms the cone.
+   * @param order The order of the cone input bindings.
+   */
+  struct ConeRequest {
+    GateId root;
+    DynamicCut cut;
+    Order order;
+  };
 
-  bool isSubsetOf(const Cut &smaller, const Cut &bigger);
+  /**
+   * \brief Extracts the cones of many requests at once.
+   * The cones are traced concurrently on a shared snapshot of the net, then
+   * the cone nets are built one after another. Requests with the same root
+   * and cut share one cone net (their bindings follow their own orders).
+   * @param net Net where cone extraction is executed.
+   * @param requests Cones to be extracted.
+   * @param threadsNumber Number of threads tracing the cones
+   * (0 means the number of hardware threads).
+   * @param graph Snapshot of the net (if null, it is built).
+   * @param arena Arena the cone nets are created in (may be null).
+   * @return Extracted cones in the order of the requests.
+   */
+  std::vector<BoundGNet> extractCones(const GNet *net,
+                                      const std::vector<ConeRequest> &requests,
+                                      size_t threadsNumber = 1,
+                                      const CsrGraph *graph = nullptr,
+                                      ConeArena *arena = nullptr);
+
+  /**
+   * \brief Checks that all leaves of the smaller cut belong to the bigger one.
+   * The cuts are StaticCut or DynamicCut (sorted leaves and signatures).
+   */
+  template <typename SmallerCut, typename BiggerCut>
+  bool isSubsetOf(const SmallerCut &smaller, const BiggerCut &bigger) {
+    // A leaf missing in the bigger signature is missing in the cut itself.
+    if (smaller.signature() & ~bigger.signature()) {
+      return false;
+    }
+    // Leaves of both cuts are sorted.
+    return smaller.size() <= bigger.size() &&
+           std::includes(bigger.begin(), bigger.end(),
+                         smaller.begin(), smaller.end());
+  }
 
-  void getHeights(GateId start, int &maxHeight, int &minHeight, const Cut &cut);
+  void getHeights(GateId start, int &maxHeight, int &minHeight,
+                  const DynamicCut &cut);
 
 } // namespace eda::gate::optimizer
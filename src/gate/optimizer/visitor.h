@@ -45,5 +45,15 @@ namespace eda::gate::optimizer {
      * Finishes handling a tracing node.
      */
     virtual VisitorFlags onNodeEnd(const GateId &) = 0;
+
+    /**
+     * Checks whether the handlers may be called concurrently for the nodes
+     * that do not depend on each other. A reentrant visitor must only read
+     * the data of the handled predecessors of the node and write the data
+     * of the node itself (see ParallelWalker).
+     */
+    virtual bool isReentrant() const { return false; }
+
+    virtual ~Visitor() = default;
   };
 } // namespace eda::gate::optimizer
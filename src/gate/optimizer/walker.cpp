@@ -8,20 +8,22 @@
 
 #include "gate/optimizer/walker.h"
 
+#include <algorithm>
+#include <cassert>
+#include <memory>
+
 namespace eda::gate::optimizer {
 
   using GNet = eda::gate::model::GNet;
 
-  Walker::Walker(const Walker::GNet *gNet, Visitor *visitor) :
-      gNet(gNet), visitor(visitor) {}
+  Walker::Walker(const Walker::GNet *gNet, Visitor *visitor,
+                 const CsrGraph *graph) :
+      gNet(gNet), visitor(visitor), graph(graph) {}
 
 
   void Walker::walk(const std::vector<GateId> &nodes, bool forward) {
-    auto begin = forward ? nodes.begin() : std::prev(nodes.end());
-    auto end = forward ? nodes.end() : std::prev(nodes.begin(), -1);
-
-    for (auto it = begin; it != end; forward ? ++it : --it) {
-      const auto &node = *it;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      const auto &node = forward ? nodes[i] : nodes[nodes.size() - 1 - i];
       // Only FINISH_ALL_NODES, CONTINUE expected.
       switch (callVisitor(node)) {
         case FINISH_ALL_NODES:
@@ -38,163 +40,261 @@ namespace eda::gate::optimizer {
   }
 
   void Walker::walk(bool forward) {
-    auto nodes = utils::graph::topologicalSort(*gNet);
+    if (levelization) {
+      // The cached order must be invalidated after the net is edited.
+      assert(levelization->checkOrder() && "Levelization is stale");
+      // The cached order is not copied.
+      walk(levelization->getOrder(), forward);
+      return;
+    }
+    walk(utils::graph::topologicalSort(*gNet), forward);
+  }
 
-    if (!forward) {
-      std::reverse(nodes.begin(), nodes.end());
+  /**
+   * \brief Traversal state of a walk.
+   * \ Arrays are indexed by gate identifiers. An entry is valid only if it
+   * \ is stamped with the current epoch, so the state is reset in O(1).
+   */
+  struct Walker::WalkState {
+    std::vector<uint32_t> stamps;
+    // Number of the predecessors which are not traced yet.
+    std::vector<uint32_t> degrees;
+    // Flags of the nodes reached through the visited predecessors.
+    std::vector<uint8_t> reached;
+    uint32_t epoch = 0;
+
+    // Nodes to be traced in the order of addition.
+    std::vector<GateId> region;
+    std::vector<GateId> queue;
+    std::vector<GateId> next;
+
+    void reset() {
+      region.clear();
+      queue.clear();
+      if (++epoch == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        epoch = 1;
+      }
     }
 
-    for (auto &node: nodes) {
-      // Only FINISH_ALL_NODES, CONTINUE expected.
-      switch (callVisitor(node)) {
-        case FINISH_ALL_NODES:
-          return;
-        case CONTINUE:
-        case SKIP:
-        case FINISH_FURTHER_NODES:
-          break;
-        default:
-          std::cerr << "Unexpected flag in Walker." << std::endl;
-          return;
+    bool contains(GateId node) const {
+      return node < stamps.size() && stamps[node] == epoch;
+    }
+
+    void add(GateId node) {
+      if (node >= stamps.size()) {
+        size_t size = std::max<size_t>(node + 1, 2 * stamps.size());
+        stamps.resize(size);
+        degrees.resize(size);
+        reached.resize(size);
+      }
+      if (stamps[node] != epoch) {
+        stamps[node] = epoch;
+        degrees[node] = 0;
+        reached[node] = 0;
+        region.push_back(node);
       }
     }
-  }
+  };
+
+  /**
+   * \brief Takes a walk state of the thread for the lifetime of the guard.
+   * \ States are kept between the walks. A visitor may start a walk, so
+   * \ every nested walk takes its own state.
+   */
+  class Walker::StateGuard {
+  public:
+    StateGuard() {
+      if (depth == states.size()) {
+        states.push_back(std::make_unique<WalkState>());
+      }
+      state = states[depth++].get();
+      state->reset();
+    }
+
+    ~StateGuard() {
+      --depth;
+    }
 
-  void Walker::walk(GateId start, const Cut &cut, bool forwardCone) {
-    std::unordered_set<GateId> accessed;
+    WalkState &get() { return *state; }
 
-    // First trace to define needed nodes.
-    getConeSet(start, cut, accessed, forwardCone);
+  private:
+    static thread_local std::vector<std::unique_ptr<WalkState>> states;
+    static thread_local size_t depth;
 
-    std::queue<GateId> bfs;
-    bfs.push(start);
+    WalkState *state;
+  };
+
+  thread_local std::vector<std::unique_ptr<Walker::WalkState>>
+      Walker::StateGuard::states;
+  thread_local size_t Walker::StateGuard::depth = 0;
+
+  void Walker::walk(GateId start, const DynamicCut &cut, bool forwardCone) {
+    StateGuard guard;
+
+    // First trace to define needed nodes.
+    collectCone(guard.get(), start, &cut, forwardCone);
 
     // Second trace to visit needed nodes in topological order.
-    walk(bfs, accessed, forwardCone);
+    walkRegion(guard.get(), nullptr, forwardCone);
   }
 
   void Walker::walk(Walker::GateId start, bool forward) {
-    std::unordered_set<GateId> accessed;
+    StateGuard guard;
 
     // First trace to define needed nodes.
-    getConeSet(start, accessed, forward);
-
-    std::queue<GateId> bfs;
-    bfs.push(start);
+    collectCone(guard.get(), start, nullptr, forward);
 
     // Second trace to visit needed nodes in topological order.
-    walk(bfs, accessed, forward);
+    walkRegion(guard.get(), nullptr, forward);
+  }
+
+  ConeStatus Walker::walk(GateId start, bool forward,
+                          const ConeLimits &limits) {
+    StateGuard guard;
+    ConeStatus status = collectCone(guard.get(), start, nullptr, forward,
+                                    limits);
+    walkRegion(guard.get(), nullptr, forward);
+    return status;
   }
 
-  void Walker::walk(const Walker::Cut &start,
+  void Walker::walk(const DynamicCut &start,
                     Walker::GateId end, bool forward) {
-    std::unordered_set<GateId> accessed;
+    StateGuard guard;
 
     // First trace to define needed nodes.
-    getConeSet(end, start, accessed, forward);
+    collectCone(guard.get(), end, &start, forward);
 
-    std::queue<GateId> bfs;
-    for (const auto &node: start) {
-      bfs.push(node);
-    }
     // Second trace to visit needed nodes in topological order
     // from cut to the node.
-    walk(bfs, accessed, !forward);
+    walkRegion(guard.get(), nullptr, !forward);
   }
 
-  void Walker::walk(std::queue<GateId> &bfs,
-                    std::unordered_set<GateId> &accessed,
-                    bool forward) {
-    while (!bfs.empty()) {
-      auto cur = bfs.front();
-
-      if (accessed.find(cur) != accessed.end()) {
-        if (checkVisited(accessed, cur, forward)) {
-
-          accessed.erase(cur);
-          auto next = getNext(cur, forward);
-
-          // Only FINISH_ALL_NODES, FINISH_FURTHER_NODES and CONTINUE expected.
-          auto flag = callVisitor(cur);
-          switch (flag) {
-            case FINISH_ALL_NODES:
-              return;
-            case FINISH_FURTHER_NODES:
-              continue;
-            case CONTINUE:
-            case SKIP:
-              break;
-            default:
-              std::cerr << "Unexpected flag in Walker." << std::endl;
-              return;
-          }
-
-          for (auto node: next) {
-            bfs.push(node);
-          }
-
-          if (flag == SKIP) {
-            continue;
-          }
+  ConeStatus Walker::collectCone(WalkState &state, GateId start,
+                                 const DynamicCut *cut, bool forward,
+                                 const ConeLimits &limits) const {
+    ConeStatus status = CONE_COMPLETE;
+    state.add(start);
+
+    // The region is filled in the breadth-first order, so the nodes
+    // of the same depth are stored contiguously.
+    size_t depth = 0;
+    size_t depthEnd = 1;
+    for (size_t i = 0; i < state.region.size(); ++i) {
+      if (i == depthEnd) {
+        ++depth;
+        depthEnd = state.region.size();
+      }
+      GateId cur = state.region[i];
+      if (cut && cut->find(cur) != cut->end()) {
+        continue;
+      }
 
+      bool truncated = false;
+      forEachNext(cur, forward, [&](GateId node) {
+        if (truncated || state.contains(node)) {
+          return;
+        }
+        if (depth >= limits.maxDepth) {
+          status = CONE_DEPTH_LIMIT;
+        } else if (state.region.size() >= limits.maxNodes) {
+          truncated = true;
         } else {
-          auto prev = getNext(cur, !forward);
-          for (auto node: prev) {
-            if (accessed.find(node) != accessed.end()) {
-              bfs.push(node);
-            }
-          }
+          state.add(node);
         }
+      });
+      if (truncated) {
+        return CONE_SIZE_LIMIT;
       }
-      bfs.pop();
     }
+    return status;
   }
 
-  void Walker::walkAll(std::queue<GateId> &bfs,
-                       const std::unordered_set<GateId> &used, bool forward) {
-    std::unordered_set<GateId> visited;
-
-    while (!bfs.empty()) {
-      auto cur = bfs.front();
-
-      if (visited.find(cur) == visited.end()) {
-        if (checkAllVisited(visited, used, cur, forward)) {
-
-          visited.emplace(cur);
-          auto next = getNext(cur, forward);
-
-          // Only FINISH_ALL_NODES, FINISH_FURTHER_NODES and CONTINUE expected.
-          auto flag = callVisitor(cur);
-          switch (flag) {
-            case FINISH_ALL_NODES:
-              return;
-            case FINISH_FURTHER_NODES:
-              continue;
-            case CONTINUE:
-            case SKIP:
-              break;
-            default:
-              std::cerr << "Unexpected flag in Walker." << std::endl;
-          }
-
-          for (auto node: next) {
-            bfs.push(node);
-          }
-
-          if (flag == SKIP) {
-            continue;
-          }
+  void Walker::walkAll(const std::vector<GateId> &start,
+                       const GateIdSet &used, bool forward) {
+    StateGuard guard;
+    WalkState &state = guard.get();
 
-        } else {
-          auto prev = getNext(cur, !forward);
-          for (auto node: prev) {
-            if (visited.find(node) == visited.end()) {
-              bfs.push(node);
-            }
-          }
+    // The nodes reachable from the start ones and their predecessors
+    // which are not considered to be traced.
+    for (GateId node: start) {
+      state.add(node);
+    }
+    for (size_t i = 0; i < state.region.size(); ++i) {
+      GateId cur = state.region[i];
+      forEachNext(cur, forward, [&state](GateId node) { state.add(node); });
+      forEachNext(cur, !forward, [&](GateId node) {
+        if (used.find(node) == used.end()) {
+          state.add(node);
+        }
+      });
+    }
+
+    walkRegion(state, &used, forward);
+  }
+
+  void Walker::walkRegion(WalkState &state, const GateIdSet *used,
+                          bool forward) {
+    // A predecessor is waited for if it is traced by the walk.
+    auto isWaited = [&](GateId node) {
+      return used ? used->find(node) == used->end() : state.contains(node);
+    };
+
+    for (GateId node: state.region) {
+      forEachNext(node, !forward, [&](GateId prev) {
+        if (isWaited(prev)) {
+          ++state.degrees[node];
+        }
+      });
+    }
+
+    // Nodes are visited when all their predecessors are (Kahn's algorithm).
+    for (GateId node: state.region) {
+      if (state.degrees[node] == 0) {
+        state.reached[node] = 1;
+        state.queue.push_back(node);
+      }
+    }
+
+    for (size_t i = 0; i < state.queue.size(); ++i) {
+      GateId cur = state.queue[i];
+      // Neighbours are collected before the node is visited
+      // (the visitor may modify the net).
+      collectNext(cur, forward, state.next);
+
+      // The nodes reached only through the nodes which finished further
+      // nodes are not visited.
+      bool propagate = false;
+      if (state.reached[cur]) {
+        switch (callVisitor(cur)) {
+          case FINISH_ALL_NODES:
+            return;
+          case FINISH_FURTHER_NODES:
+            break;
+          case CONTINUE:
+          case SKIP:
+            propagate = true;
+            break;
+          default:
+            std::cerr << "Unexpected flag in Walker." << std::endl;
+            return;
+        }
+      }
+
+      if (!isWaited(cur)) {
+        continue;
+      }
+      for (GateId node: state.next) {
+        if (!state.contains(node)) {
+          continue;
+        }
+        if (propagate) {
+          state.reached[node] = 1;
+        }
+        if (--state.degrees[node] == 0) {
+          state.queue.push_back(node);
         }
       }
-      bfs.pop();
     }
   }
 
@@ -208,47 +308,24 @@ namespace eda::gate::optimizer {
     return visitor->onNodeEnd(node);
   }
 
-  bool Walker::checkAllVisited(const std::unordered_set<GateId> &visited,
-                               const std::unordered_set<GateId> &used,
-                               GateId node, bool forward) {
-    if (forward) {
-      const auto &inputs = Gate::get(node)->inputs();
-      for (const auto &in: inputs) {
-        if (visited.find(in.node()) == visited.end() &&
-            used.find(in.node()) == used.end()) {
-          return false;
-        }
+  void Walker::collectNext(GateId node, bool forward,
+                           std::vector<GateId> &next) const {
+    next.clear();
+    if (graph) {
+      auto index = graph->indexOf(node);
+      assert(index != CsrGraph::NO_INDEX && "Node is out of the snapshot");
+      for (auto nextIndex: graph->next(index, forward)) {
+        next.push_back(graph->gateId(nextIndex));
       }
-    } else {
-      const auto &outputs = Gate::get(node)->links();
-      for (const auto &out: outputs) {
-        if (visited.find(out.target) == visited.end() &&
-            used.find(out.target) == used.end()) {
-          return false;
-        }
-      }
-    }
-    return true;
-  }
-
-  bool Walker::checkVisited(const std::unordered_set<GateId> &accessed,
-                            GateId node, bool forward) {
-    if (forward) {
-      const auto &inputs = Gate::get(node)->inputs();
-      for (const auto &in: inputs) {
-        if (accessed.find(in.node()) != accessed.end()) {
-          return false;
-        }
+    } else if (forward) {
+      for (const auto &out: Gate::get(node)->links()) {
+        next.push_back(out.target);
       }
     } else {
-      const auto &outputs = Gate::get(node)->links();
-      for (const auto &out: outputs) {
-        if (accessed.find(out.target) != accessed.end()) {
-          return false;
-        }
+      for (const auto &in: Gate::get(node)->inputs()) {
+        next.push_back(in.node());
       }
     }
-    return true;
   }
 
 } // namespace eda::gate::optimizer
\ No newline at end of file
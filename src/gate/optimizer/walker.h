@@ -9,7 +9,10 @@
 #pragma once
 
 #include "gate/model/gnet.h"
+#include "gate/optimizer/cone_limits.h"
+#include "gate/optimizer/csr_graph.h"
 #include "gate/optimizer/cut_storage.h"
+#include "gate/optimizer/levelization.h"
 #include "gate/optimizer/util.h"
 #include "gate/optimizer/visitor.h"
 #include "util/graph.h"
@@ -35,25 +38,63 @@ namespace eda::gate::optimizer {
   protected:
     const GNet *gNet;
     Visitor *visitor;
+    const CsrGraph *graph;
+    Levelization *levelization = nullptr;
 
     virtual VisitorFlags callVisitor(GateId node);
 
   private:
-    void walk(GateIdQueue &start, GateIdSet &accessed, bool forward);
-
-    void walkAll(GateIdQueue &start, const GateIdSet &used, bool forward);
-
-    bool checkVisited(const GateIdSet &visited, GateId node, bool forward);
-
-    bool checkAllVisited(const GateIdSet &visited, const GateIdSet &used,
-                         GateId node, bool forward);
+    struct WalkState;
+    class StateGuard;
+
+    ConeStatus collectCone(WalkState &state, GateId start,
+                           const DynamicCut *cut, bool forward,
+                           const ConeLimits &limits = ConeLimits()) const;
+
+    void walkRegion(WalkState &state, const GateIdSet *used, bool forward);
+
+    void walkAll(const std::vector<GateId> &start, const GateIdSet &used,
+                 bool forward);
+
+    void collectNext(GateId node, bool forward,
+                     std::vector<GateId> &next) const;
+
+    template <typename F>
+    void forEachNext(GateId node, bool forward, F f) const {
+      if (graph) {
+        for (auto index: graph->next(graph->indexOf(node), forward)) {
+          f(graph->gateId(index));
+        }
+      } else if (forward) {
+        for (const auto &out: Gate::get(node)->links()) {
+          f(out.target);
+        }
+      } else {
+        for (const auto &in: Gate::get(node)->inputs()) {
+          f(in.node());
+        }
+      }
+    }
 
   public:
     /**
      * @param gNet Net to be traced.
      * @param visitor Node handler.
+     * @param graph Snapshot of the net used to get the node neighbours
+     * (if null, the neighbours are taken from the gates).
+     * The net must not be modified while the snapshot is used.
+     */
+    Walker(const GNet *gNet, Visitor *visitor,
+           const CsrGraph *graph = nullptr);
+
+    /**
+     * Sets the cached topological order of the net used by walk(bool).
+     * Otherwise the net is sorted on every call. The order is not checked
+     * against the net: it must be invalidated after the net is edited.
      */
-    Walker(const GNet *gNet, Visitor *visitor);
+    void setLevelization(Levelization *levelization) {
+      this->levelization = levelization;
+    }
 
     /**
      * Traces all nodes in topological order and calls the handler on each node.
@@ -75,7 +116,7 @@ namespace eda::gate::optimizer {
      * @param cut Cone base.
      * @param forward Direction to perform a trace in.
      */
-    void walk(GateId start, const Cut &end, bool forward);
+    void walk(GateId start, const DynamicCut &end, bool forward);
 
     /**
      * Traces nodes from a cone in topological order and calls the handler on each node.
@@ -84,7 +125,7 @@ namespace eda::gate::optimizer {
      * @param end Cone vertex.
      * @param forward Direction to perform a trace in.
      */
-    void walk(const Cut &start, GateId end, bool forward);
+    void walk(const DynamicCut &start, GateId end, bool forward);
 
     /**
      * Traces nodes from a cone in topological order and calls the handler on each node.
@@ -95,22 +136,37 @@ namespace eda::gate::optimizer {
      */
     void walk(GateId start, bool forward);
 
+    /**
+     * Traces nodes from a bounded cone in topological order and calls
+     * the handler on each node. Trace is performed from the cone vertex.
+     * The nodes at the max depth form the base of the cone. If the node
+     * budget is exceeded, only the nodes found so far (the nearest ones)
+     * are traced.
+     * @param start Cone vertex.
+     * @param forward Direction to perform a trace in.
+     * @param limits Bounds of the cone.
+     * @return Reason why the cone is not traced up to the net boundary.
+     */
+    ConeStatus walk(GateId start, bool forward, const ConeLimits &limits);
+
     /**
      * Starts walking from the nodes from listed collection.
+     * The nodes reachable from the start ones are traced. The predecessors
+     * of a traced node are traced before it unless they are in used.
      * Can handle FINISH_FURTHER_NODES visitor flag.
      * @tparam L Some collection of nodes.
      * @param start Nodes with which a trace starts.
-     * @param used Set of all nodes that needs be traced.
+     * @param used Set of the nodes which are considered to be traced.
      */
     template<typename L>
     void walk(L start, const GateIdSet &used) {
 
-      std::queue<GateId> bfs;
+      std::vector<GateId> nodes;
       for (const auto &node: start) {
-        bfs.push(node);
+        nodes.push_back(node);
       }
 
-      walkAll(bfs, used, true);
+      walkAll(nodes, used, true);
     }
 
   };
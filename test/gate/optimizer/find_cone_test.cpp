@@ -7,12 +7,21 @@
 //===----------------------------------------------------------------------===//
 
 #include "gate/model/examples.h"
+#include "gate/optimizer/cone_view.h"
 #include "gate/optimizer/cone_visitor.h"
+#include "gate/optimizer/cuts_finder_visitor.h"
+#include "gate/optimizer/levelization.h"
 #include "gate/optimizer/optimizer_util.h"
+#include "gate/optimizer/parallel_walker.h"
+#include "gate/optimizer/static_walker.h"
+#include "gate/parser/graphml.h"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <stdexcept>
 #include <string>
 
 namespace eda::gate::optimizer {
@@ -179,4 +188,343 @@ namespace eda::gate::optimizer {
               Gate::get(matchMap[1])->links().size());
   }
 
-} // namespace eda::gate::optimizer
\ No newline at end of file
+  TEST(FindConeTest, extractConeManyLeaves) {
+    GNet net;
+    Order order;
+    std::vector<base::model::Signal<GateId>> signals;
+    for (size_t i = 0; i <= Cut::CAPACITY; ++i) {
+      order.push_back(net.addIn());
+      signals.emplace_back(base::model::Event::ALWAYS, order.back());
+    }
+    GateId root = net.addGate(model::GateSymbol::AND, signals);
+    net.addOut(root);
+
+    // The cones may have bases of any size.
+    DynamicCut base(order.rbegin(), order.rend());
+    EXPECT_EQ(order.size(), base.size());
+    EXPECT_TRUE(std::equal(order.begin(), order.end(), base.begin()));
+    EXPECT_EQ(1, base.count(order.back()));
+    EXPECT_EQ(0, base.count(root));
+
+    ConeSet cone;
+    getConeSet(root, base, cone, false);
+    EXPECT_EQ(order.size() + 1, cone.size());
+
+    auto bound = extractCone(&net, root, order);
+    EXPECT_EQ(order.size(), bound.inputBindings.size());
+    EXPECT_EQ(order.size(), bound.net->nSourceLinks());
+
+    auto bounds = extractCones(&net, {{root, base, order}}, 2);
+    ASSERT_EQ(1, bounds.size());
+    EXPECT_EQ(order.size(), bounds[0].net->nSourceLinks());
+
+    // The enumerated cuts have a fixed capacity.
+    EXPECT_THROW(Cut(order.begin(), order.end()), std::length_error);
+    order.pop_back();
+    Cut cut(order.begin(), order.end());
+    EXPECT_EQ(Cut::CAPACITY, cut.size());
+    EXPECT_THROW(cut.emplace(root), std::length_error);
+    EXPECT_EQ(Cut::CAPACITY, cut.size());
+    EXPECT_TRUE(isSubsetOf(cut, base));
+    EXPECT_FALSE(isSubsetOf(base, cut));
+    EXPECT_EQ(DynamicCut(order.begin(), order.end()), DynamicCut(cut));
+
+    CutStorage storage;
+    EXPECT_THROW(CutsFindVisitor(Cut::CAPACITY + 1, &storage),
+                 std::invalid_argument);
+  }
+
+  TEST(FindConeTest, extractCones) {
+    GNet net;
+    auto g = gnet3(net);
+
+    Order order = {g[2], g[3], g[4], g[6], g[7]};
+    Order reversed(order.rbegin(), order.rend());
+    Cut cut(order.begin(), order.end());
+    std::vector<ConeRequest> requests = {
+      {g[14], cut, order}, {g[5], Cut{g[5]}, {g[5]}},
+      {g[14], cut, reversed}
+    };
+
+    auto cones = extractCones(&net, requests, 2);
+    ASSERT_EQ(requests.size(), cones.size());
+
+    // The identical cones share the net.
+    EXPECT_EQ(cones[0].net, cones[2].net);
+    for (size_t i = 0; i < requests.size(); ++i) {
+      const auto &request = requests[i];
+      auto expected = extractCone(&net, request.root, request.cut,
+                                  request.order);
+      EXPECT_EQ(expected.net->nGates(), cones[i].net->nGates());
+      ASSERT_EQ(request.order.size(), cones[i].inputBindings.size());
+      for (size_t j = 0; j < request.order.size(); ++j) {
+        EXPECT_EQ(Gate::get(expected.inputBindings[j])->links().size(),
+                  Gate::get(cones[i].inputBindings[j])->links().size());
+      }
+    }
+  }
+
+  TEST(FindConeTest, coneView) {
+    GNet net;
+    auto g = gnet3(net);
+    Order order = {g[2], g[3], g[4], g[6], g[7]};
+    Cut cut(order.begin(), order.end());
+
+    ConeViewBuilder builder;
+    ConeView view = builder.build(g[14], cut);
+    EXPECT_EQ(g[14], view.getRoot());
+
+    ConeSet cone;
+    getConeSet(g[14], cut, cone, false);
+    ASSERT_EQ(cone.size(), view.size());
+    for (size_t i = 0; i < view.size(); ++i) {
+      EXPECT_TRUE(cone.count(view.getNode(i)));
+    }
+
+    int maxHeight, minHeight, viewMaxHeight, viewMinHeight;
+    getHeights(g[14], maxHeight, minHeight, cut);
+    view.getHeights(viewMaxHeight, viewMinHeight);
+    EXPECT_EQ(maxHeight, viewMaxHeight);
+    EXPECT_EQ(minHeight, viewMinHeight);
+
+    auto expected = extractCone(&net, g[14], cut, order);
+    EXPECT_EQ(expected.net->nGates(), view.materialize(order).net->nGates());
+
+    // The table of the root is the simulation of the variable tables.
+    uint64_t table, value;
+    std::vector<uint64_t> values;
+    std::vector<uint64_t> leafValues = {
+      0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+      0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull
+    };
+    ASSERT_TRUE(view.getTruthTable(table));
+    ASSERT_TRUE(view.simulate(leafValues, values, value));
+    EXPECT_EQ(table, value);
+  }
+
+  TEST(FindConeTest, coneArena) {
+    GNet net;
+    auto g = gnet3(net);
+    Order order = {g[2], g[3], g[4], g[6], g[7]};
+    Cut cut(order.begin(), order.end());
+
+    ConeArena arena(2);
+    std::vector<ConeRequest> requests = {
+      {g[14], cut, order}, {g[5], Cut{g[5]}, {g[5]}}, {g[14], cut, order}
+    };
+    auto cones = extractCones(&net, requests, 1, nullptr, &arena);
+    auto single = extractCone(&net, g[14], cut, order, nullptr, &arena);
+
+    auto stats = arena.getStats();
+    EXPECT_EQ(3, stats.nets);
+    EXPECT_EQ(2, stats.chunks);
+    EXPECT_EQ(3, stats.liveNets);
+
+    // The released nets are kept while they are referenced.
+    arena.release();
+    EXPECT_EQ(0, arena.getStats().liveNets);
+    EXPECT_EQ(1, arena.getStats().releases);
+    EXPECT_EQ(single.net->nGates(), cones[0].net->nGates());
+  }
+
+  class OrderVisitor : public Visitor {
+  public:
+    std::vector<GateId> order;
+
+    VisitorFlags onNodeBegin(const GateId &node) override {
+      order.push_back(node);
+      return CONTINUE;
+    }
+
+    VisitorFlags onNodeEnd(const GateId &) override {
+      return CONTINUE;
+    }
+  };
+
+  TEST(FindConeTest, walkOrder) {
+    GNet net;
+    auto g = gnet3(net);
+    Cut cut = {g[2], g[3], g[4], g[6], g[7]};
+
+    // Walks reuse the traversal state.
+    for (int i = 0; i < 2; ++i) {
+      OrderVisitor visitor;
+      Walker walker(&net, &visitor);
+      walker.walk(cut, g[14], false);
+
+      ConeSet cone;
+      getConeSet(g[14], cut, cone, false);
+      ASSERT_EQ(cone.size(), visitor.order.size());
+      EXPECT_EQ(g[14], visitor.order.back());
+
+      // Fanins of a node inside the cone are visited before it.
+      std::unordered_map<GateId, size_t> positions;
+      for (size_t j = 0; j < visitor.order.size(); ++j) {
+        positions[visitor.order[j]] = j;
+      }
+      for (GateId node: visitor.order) {
+        if (cut.find(node) != cut.end()) {
+          continue;
+        }
+        for (const auto &input: Gate::get(node)->inputs()) {
+          ASSERT_TRUE(positions.count(input.node()));
+          EXPECT_LT(positions[input.node()], positions[node]);
+        }
+      }
+    }
+  }
+
+  // Computes the node levels reading the levels of the fanins only.
+  class HeightVisitor : public Visitor {
+  public:
+    std::unordered_map<GateId, size_t> heights;
+
+    explicit HeightVisitor(const GNet &net) {
+      // The map is not modified by the handlers.
+      for (const auto *gate: net.gates()) {
+        heights[gate->id()] = 0;
+      }
+    }
+
+    VisitorFlags onNodeBegin(const GateId &node) override {
+      size_t height = 0;
+      for (const auto &input: Gate::get(node)->inputs()) {
+        height = std::max(height, heights.at(input.node()) + 1);
+      }
+      heights.at(node) = height;
+      return CONTINUE;
+    }
+
+    VisitorFlags onNodeEnd(const GateId &) override {
+      return CONTINUE;
+    }
+
+    bool isReentrant() const override { return true; }
+  };
+
+  TEST(FindConeTest, parallelWalk) {
+    GNet net;
+    gnet3(net);
+    Levelization levelization(&net);
+
+    HeightVisitor visitor(net);
+    ParallelWalker walker(&net, &visitor, 4);
+    walker.walk(true);
+    for (const auto &[node, height]: visitor.heights) {
+      EXPECT_EQ(levelization.getLevel(node), height);
+    }
+
+    // Not reentrant visitors are handled by a single thread.
+    OrderVisitor order;
+    ParallelWalker(&net, &order, 4).walk(false);
+    ASSERT_EQ(net.nGates(), order.order.size());
+    std::unordered_map<GateId, size_t> positions;
+    for (size_t i = 0; i < order.order.size(); ++i) {
+      positions[order.order[i]] = i;
+    }
+    for (GateId node: order.order) {
+      for (const auto &input: Gate::get(node)->inputs()) {
+        EXPECT_GT(positions[input.node()], positions[node]);
+      }
+    }
+  }
+
+  TEST(FindConeTest, parallelWalkStarved) {
+    using Signal = base::model::Signal<GateId>;
+    using base::model::Event;
+
+    GNet net;
+    GateId a = net.addIn();
+    GateId lhs = net.addGate(model::GateSymbol::AND,
+                             {Signal(Event::ALWAYS, a),
+                              Signal(Event::ALWAYS, a)});
+    GateId rhs = net.addGate(model::GateSymbol::AND,
+                             {Signal(Event::ALWAYS, lhs),
+                              Signal(Event::ALWAYS, a)});
+    net.setGate(lhs, model::GateSymbol::AND,
+                {Signal(Event::ALWAYS, a), Signal(Event::ALWAYS, rhs)});
+    net.addOut(rhs);
+
+    // The nodes on the cycle and after it never become ready.
+    HeightVisitor heights(net);
+    ParallelWalker parallel(&net, &heights, 4);
+    parallel.walk(true);
+    EXPECT_EQ(3, parallel.getRemaining());
+
+    OrderVisitor order;
+    ParallelWalker single(&net, &order, 4);
+    single.walk(true);
+    EXPECT_EQ(3, single.getRemaining());
+    EXPECT_EQ(std::vector<GateId>{a}, order.order);
+  }
+
+  class CountVisitor final : public Visitor {
+  public:
+    size_t count = 0;
+
+    VisitorFlags onNodeBegin(const GateId &) override {
+      ++count;
+      return CONTINUE;
+    }
+
+    VisitorFlags onNodeEnd(const GateId &) override {
+      return CONTINUE;
+    }
+  };
+
+  TEST(FindConeTest, staticWalk) {
+    GNet net;
+    auto g = gnet3(net);
+    Cut cut = {g[2], g[3], g[4], g[6], g[7]};
+
+    OrderVisitor expected, actual;
+    Walker(&net, &expected).walk(cut, g[14], false);
+    StaticWalker<OrderVisitor>(&net, &actual).walk(cut, g[14], false);
+    EXPECT_EQ(expected.order, actual.order);
+
+    CountVisitor counter;
+    StaticWalker<CountVisitor>(&net, &counter).walk(true);
+    EXPECT_EQ(net.nGates(), counter.count);
+  }
+
+  template <typename W>
+  double walkTime(W &walker, size_t repeats) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; ++i) {
+      walker.walk(true);
+    }
+    std::chrono::duration<double, std::milli> time =
+        std::chrono::steady_clock::now() - start;
+    return time.count() / repeats;
+  }
+
+  TEST(FindConeTest, staticWalkBenchmark) {
+    if (!getenv("UTOPIA_HOME")) {
+      FAIL() << "UTOPIA_HOME is not set.";
+    }
+    const std::filesystem::path homePath = std::string(getenv("UTOPIA_HOME"));
+    const std::filesystem::path filename = homePath / "test" / "data" /
+        "gate" / "parser" / "graphml" / "sha256_orig.bench.graphml";
+    GNet *net = parser::graphml::GraphMLParser::parse(filename.string());
+
+    Levelization levelization(net);
+    CsrGraph graph(*net);
+    const size_t repeats = 20;
+
+    CountVisitor dynamicCounter;
+    Walker walker(net, &dynamicCounter, &graph);
+    walker.setLevelization(&levelization);
+    double dynamicTime = walkTime(walker, repeats);
+
+    CountVisitor staticCounter;
+    StaticWalker<CountVisitor> staticWalker(net, &staticCounter, &graph);
+    staticWalker.setLevelization(&levelization);
+    double staticTime = walkTime(staticWalker, repeats);
+
+    std::cout << net->nGates() << " gates: Walker " << dynamicTime
+              << " ms, StaticWalker " << staticTime << " ms" << std::endl;
+    EXPECT_EQ(dynamicCounter.count, staticCounter.count);
+    delete net;
+  }
+
+} // namespace eda::gate::optimizer
@@ -7,7 +7,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "gate/model/examples.h"
+#include "gate/optimizer/cut_truth_table.h"
 #include "gate/optimizer/optimizer.h"
+#include "gate/optimizer/parallel_cuts_finder.h"
 #include "gate/optimizer/util.h"
 #include "gate/parser/gate_verilog.h"
 #include "gate/printer/dot.h"
@@ -15,6 +17,7 @@
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <string>
 #include <chrono>
@@ -82,6 +85,175 @@ namespace eda::gate::optimizer {
     findCutsTest(&gNet);
   }
 
+  void priorityCutsTest(GNet *net, CutCost &cost, unsigned maxCutsNumber) {
+    CutStorage storage = findPriorityCuts(net, 4, maxCutsNumber, cost);
+    for (const auto &[v, cs]: storage.cuts) {
+      EXPECT_LE(cs.size(), maxCutsNumber + 1);
+    }
+    checkCutStorage(storage);
+  }
+
+  TEST(FindCutTest, PriorityCuts_c17) {
+    auto gNet = getLorinaGnet("c17.v");
+    AreaFlowCost areaFlow;
+    priorityCutsTest(gNet, areaFlow, 2);
+    DepthCost depth;
+    priorityCutsTest(gNet, depth, 2);
+    delete gNet;
+  }
+
+  TEST(FindCutTest, PriorityCuts_adder) {
+    auto gNet = getLorinaGnet("adder.v");
+    LeafCountCost leafCount;
+    priorityCutsTest(gNet, leafCount, 4);
+    FanoutWeightedSizeCost fanoutWeighted;
+    priorityCutsTest(gNet, fanoutWeighted, 4);
+    delete gNet;
+  }
+
+  void parallelCutsTest(const std::string &name) {
+    GNet *gNet = getLorinaGnet(name);
+    CutStorage serial = findCuts(gNet, 4, CutsFindVisitor::ALL_CUTS, false);
+    CutStorage parallel = findCutsParallel(gNet, 4, CutsFindVisitor::ALL_CUTS,
+                                           4);
+    EXPECT_TRUE(serial.cuts == parallel.cuts);
+    delete gNet;
+  }
+
+  TEST(FindCutTest, ParallelFindCuts_adder) {
+    parallelCutsTest("adder.v");
+  }
+
+  TEST(FindCutTest, ParallelFindCuts_div) {
+    parallelCutsTest("div.v");
+  }
+
+  TEST(FindCutTest, DeepChainWithoutRecursion) {
+    GNet gNet;
+    GateId a = gNet.addIn();
+    GateId b = gNet.addIn();
+    GateId last = a;
+    for (int i = 0; i < 200000; ++i) {
+      std::vector<base::model::Signal<GateId>> inputs;
+      inputs.emplace_back(base::model::Event::ALWAYS, last);
+      inputs.emplace_back(base::model::Event::ALWAYS, i % 2 ? a : b);
+      last = gNet.addGate(model::GateSymbol::AND, inputs);
+    }
+
+    // Fanins of the last node are not handled before it.
+    CutStorage storage;
+    CutsFindVisitor visitor(4, &storage);
+    visitor.onNodeBegin(last);
+    EXPECT_EQ(gNet.nGates(), storage.cuts.size());
+  }
+
+  TEST(FindCutTest, IncrementalUpdate_adder) {
+    GNet *gNet = getLorinaGnet("adder.v");
+    CutStorage storage;
+    CutsFindVisitor visitor(4, &storage);
+    Levelization levelization(gNet);
+    visitor.enumerate(levelization.getOrder());
+
+    // Connecting a gate from the middle of the net to a net input.
+    GateId source = *gNet->getSources().begin();
+    NetChanges changes;
+    for (size_t i = gNet->nGates() / 2; i < gNet->nGates(); ++i) {
+      const Gate *gate = gNet->gates()[i];
+      if (gate->arity() == 2 && !gate->isTarget()) {
+        auto inputs = gate->inputs();
+        inputs[0] = base::model::Signal<GateId>(base::model::Event::ALWAYS,
+                                                source);
+        gNet->setGate(gate->id(), gate->func(), inputs);
+        changes.modified.push_back(gate->id());
+        break;
+      }
+    }
+    ASSERT_FALSE(changes.modified.empty());
+
+    // The number of the gates is the same: the levels are invalidated
+    // by the update.
+    visitor.update(changes, &levelization);
+    CutStorage fresh = findCuts(gNet, 4, CutsFindVisitor::ALL_CUTS, false);
+    EXPECT_TRUE(storage.cuts == fresh.cuts);
+
+    Levelization freshLevelization(gNet);
+    EXPECT_EQ(freshLevelization.getDepth(), levelization.getDepth());
+    for (GateId gate: freshLevelization.getOrder()) {
+      EXPECT_EQ(freshLevelization.getLevel(gate), levelization.getLevel(gate));
+    }
+    delete gNet;
+  }
+
+  TEST(FindCutTest, StaticCutMerge) {
+    Cut lhs = {7, 3, 5};
+    Cut rhs = {5, 1};
+
+    EXPECT_EQ(std::vector<GateId>({3, 5, 7}),
+              std::vector<GateId>(lhs.begin(), lhs.end()));
+
+    Cut merged;
+    ASSERT_TRUE(Cut::merge(lhs, rhs, 4, merged));
+    EXPECT_EQ(merged, Cut({1, 3, 5, 7}));
+    EXPECT_EQ(merged.signature(), lhs.signature() | rhs.signature());
+    EXPECT_FALSE(Cut::merge(lhs, rhs, 3, merged));
+
+    EXPECT_TRUE(isSubsetOf(rhs, merged));
+    EXPECT_FALSE(isSubsetOf(rhs, lhs));
+    EXPECT_NE(merged.find(3), merged.end());
+    EXPECT_EQ(merged.find(4), merged.end());
+  }
+
+  TEST(FindCutTest, StaticCutSet) {
+    Cuts cuts;
+    EXPECT_TRUE(cuts.emplace(Cut({1, 2})).second);
+    EXPECT_TRUE(cuts.emplace(Cut({3})).second);
+    EXPECT_FALSE(cuts.emplace(Cut({2, 1})).second);
+    EXPECT_EQ(2, cuts.size());
+
+    cuts.erase(cuts.find(Cut({1, 2})));
+    EXPECT_EQ(1, cuts.size());
+    EXPECT_EQ(Cut({3}), *cuts.begin());
+  }
+
+  TEST(FindCutTest, CutTruthTables) {
+    GNet gNet;
+    GateId a = gNet.addIn();
+    GateId b = gNet.addIn();
+    GateId c = gNet.addIn();
+    GateId andAB = gNet.addGate(model::GateSymbol::AND, {
+        base::model::Signal<GateId>(base::model::Event::ALWAYS, a),
+        base::model::Signal<GateId>(base::model::Event::ALWAYS, b)});
+    GateId notC = gNet.addGate(model::GateSymbol::NOT, {
+        base::model::Signal<GateId>(base::model::Event::ALWAYS, c)});
+    GateId root = gNet.addGate(model::GateSymbol::XOR, {
+        base::model::Signal<GateId>(base::model::Event::ALWAYS, andAB),
+        base::model::Signal<GateId>(base::model::Event::ALWAYS, notC)});
+
+    CutStorage storage;
+    CutsFindVisitor visitor(4, &storage);
+    visitor.setTruthTables(true);
+    visitor.enumerate(utils::graph::topologicalSort(gNet));
+
+    const uint64_t x0 = 0xAAAAAAAAAAAAAAAAull;
+    const uint64_t x1 = 0xCCCCCCCCCCCCCCCCull;
+    const uint64_t x2 = 0xF0F0F0F0F0F0F0F0ull;
+
+    const auto &cuts = storage.cuts[root];
+    auto wide = cuts.find(Cut({a, b, c}));
+    ASSERT_NE(wide, cuts.end());
+    ASSERT_TRUE(wide->hasTruthTable());
+    EXPECT_EQ((x0 & x1) ^ ~x2, wide->truthTable());
+
+    auto narrow = cuts.find(Cut({andAB, c}));
+    ASSERT_NE(narrow, cuts.end());
+    ASSERT_TRUE(narrow->hasTruthTable());
+    EXPECT_EQ(~x0 ^ x1, narrow->truthTable());
+
+    EXPECT_EQ(x1, expandCutTable(x0, Cut({5}), Cut({3, 5, 7})));
+    EXPECT_TRUE(dependsOnVariable(x0 ^ x2, 2));
+    EXPECT_FALSE(dependsOnVariable(x0 ^ x2, 1));
+  }
+
   std::pair<int, double> calculateCutsMetrics(const CutStorage &storage) {
     int totalCuts = 0;
     int gateCount = 0;
@@ -222,4 +394,50 @@ namespace eda::gate::optimizer {
     delete gNet;
   }
 
+  CutStorage findCutsTimed(int cutSize, bool filter,
+                           const std::vector<GateId> &order) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    CutStorage storage;
+    CutsFindVisitor visitor(cutSize, &storage);
+    visitor.setSignatureFilter(filter);
+    visitor.enumerate(order);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        end - start);
+
+    auto [totalCuts, avgCutsPerGate] = calculateCutsMetrics(storage);
+    std::cout << (filter ? "With" : "Without") << " signatures : totalCuts = "
+              << totalCuts << " avgCutsPerGate = " << avgCutsPerGate
+              << std::endl;
+    std::cout << "Execution time: " << duration.count()
+              << " milliseconds\n" << std::endl;
+    return storage;
+  }
+
+  // Compares the enumeration with and without rejecting the dominance
+  // checks by the leaf signatures.
+  void findCutsSignatureCompare(const GNet *gNet, int cutSize) {
+    std::cout << "gates number = " << gNet->nGates() << std::endl;
+
+    Levelization levelization(gNet);
+    const auto &order = levelization.getOrder();
+    CutStorage storageOld = findCutsTimed(cutSize, false, order);
+    CutStorage storageNew = findCutsTimed(cutSize, true, order);
+    EXPECT_TRUE(storageOld.cuts == storageNew.cuts);
+  }
+
+  TEST(CutsSignatureCompareTest, div) {
+    GNet *gNet = getLorinaGnet("div.v");
+    findCutsSignatureCompare(gNet, 4);
+    delete gNet;
+  }
+
+  TEST(CutsSignatureCompareTest, multiplier) {
+    GNet *gNet = getLorinaGnet("multiplier.v");
+    findCutsSignatureCompare(gNet, 4);
+    delete gNet;
+  }
+
 } // namespace eda::gate::optimizer
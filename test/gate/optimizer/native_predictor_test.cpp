@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/native_predictor.h"
+
+#include "gtest/gtest.h"
+
+#include <filesystem>
+
+namespace eda::gate::optimizer {
+
+  using Predictor = NativeScenarioPredictor;
+
+  static std::string getModelPath(const std::string &name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+  }
+
+  TEST(NativePredictorTest, TreesAfterLoading) {
+    // Inputs: 2 features, the counts of "rw" and "b", the number of steps.
+    Predictor model(Predictor::GBDT, 2, {"rw", "b"});
+    model.setBaseScore(0.5f);
+    model.addTree({{2, 1.5f, 1, 2}, {-1, 1.f, 0, 0}, {-1, 2.f, 0, 0}});
+    model.addTree({{0, 10.f, 1, 2}, {-1, -1.f, 0, 0}, {4, 3.f, 3, 4},
+                   {-1, 0.f, 0, 0}, {-1, 5.f, 0, 0}});
+    ASSERT_TRUE(model.isValid());
+
+    const auto path = getModelPath("gbdt_model.bin");
+    ASSERT_TRUE(model.save(path));
+    auto loaded = Predictor::load(path);
+    ASSERT_NE(loaded, nullptr);
+
+    const float features[] = {5.f, 0.f, 20.f, 0.f};
+    const std::vector<std::string> scenarios = {"rw; b", "rw rw b; b", ""};
+    std::vector<double> qualities;
+    ASSERT_TRUE(loaded->predict(features, 2, 2, scenarios, qualities));
+
+    const std::vector<double> expected = {
+      0.5 + 1 - 1, 0.5 + 2 - 1, 0.5 + 1 - 1,
+      0.5 + 1 + 0, 0.5 + 2 + 5, 0.5 + 1 + 0
+    };
+    EXPECT_EQ(qualities, expected);
+    EXPECT_FALSE(loaded->predict(features, 1, 4, scenarios, qualities));
+  }
+
+  TEST(NativePredictorTest, LayersAfterLoading) {
+    Predictor model(Predictor::MLP, 1, {"rw"});
+    model.addLayer({3, 2, Predictor::RELU, {1, 0, 0, 0, 1, -1}, {0, 1}});
+    model.addLayer({2, 1, Predictor::LINEAR, {2, 3}, {-1}});
+    ASSERT_TRUE(model.isValid());
+
+    const auto path = getModelPath("mlp_model.bin");
+    ASSERT_TRUE(model.save(path));
+    auto loaded = Predictor::load(path);
+    ASSERT_NE(loaded, nullptr);
+
+    const float features[] = {4.f};
+    const std::vector<std::string> scenarios = {"rw,rw,x", "x"};
+    std::vector<double> qualities;
+    ASSERT_TRUE(loaded->predict(features, 1, 1, scenarios, qualities));
+
+    // The hidden values are (4, relu(rw - steps + 1)).
+    EXPECT_DOUBLE_EQ(qualities[0], 2 * 4 + 3 * 0 - 1);
+    EXPECT_DOUBLE_EQ(qualities[1], 2 * 4 + 3 * 0 - 1);
+
+    model.addLayer({1, 1, Predictor::LINEAR, {1}, {0}});
+    model.addLayer({1, 2, Predictor::LINEAR, {1}, {0}});
+    EXPECT_FALSE(model.isValid());
+  }
+
+} // namespace eda::gate::optimizer
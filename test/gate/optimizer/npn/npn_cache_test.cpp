@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/npn/npn_cache.h"
+
+#include "gtest/gtest.h"
+
+#include <kitty/npn.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+namespace eda::gate::optimizer {
+
+  uint64_t exactNPN(uint64_t table) {
+    kitty::static_truth_table<6> kt;
+    kt._bits = table;
+    return std::get<0>(kitty::exact_npn_canonization(kt))._bits;
+  }
+
+  TEST(NPNCacheTest, SameAsExactCanonization) {
+    NPNCache cache;
+    // AND of 2 variables (a small function) and a 6-variable function.
+    const uint64_t tables[] = {0x8888888888888888ull, 0x8000000000000001ull};
+    for (uint64_t table: tables) {
+      EXPECT_EQ(exactNPN(table), cache.canonize(table).canonical);
+      EXPECT_EQ(exactNPN(table), cache.canonize(table).canonical);
+    }
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(2, cache.misses());
+    EXPECT_EQ(2, cache.hits());
+    EXPECT_DOUBLE_EQ(0.5, cache.hitRate());
+  }
+
+  TEST(NPNCacheTest, SaveAndLoad) {
+    NPNCache cache;
+    const uint64_t tables[] = {0x6666666666666666ull, 0x0123456789ABCDEFull};
+    for (uint64_t table: tables) {
+      cache.canonize(table);
+    }
+    const auto path = std::filesystem::temp_directory_path() / "npn_cache.bin";
+    ASSERT_TRUE(cache.save(path));
+
+    NPNCache loaded;
+    ASSERT_TRUE(loaded.load(path));
+    EXPECT_EQ(cache.size(), loaded.size());
+    for (uint64_t table: tables) {
+      const auto expected = cache.canonize(table);
+      const auto actual = loaded.canonize(table);
+      EXPECT_EQ(expected.canonical, actual.canonical);
+      EXPECT_EQ(expected.phase, actual.phase);
+      EXPECT_EQ(expected.permutation, actual.permutation);
+    }
+    EXPECT_EQ(0, loaded.misses());
+    std::filesystem::remove(path);
+  }
+
+  TEST(NPNCacheTest, LoadTruncated) {
+    NPNCache cache;
+    cache.canonize(0x6666666666666666ull);
+    const auto path =
+        std::filesystem::temp_directory_path() / "npn_cache_truncated.bin";
+    ASSERT_TRUE(cache.save(path));
+
+    // The count follows the magic and the version.
+    {
+      std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+      const uint64_t count = uint64_t(1) << 60;
+      file.seekp(4 + sizeof(uint32_t));
+      file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    }
+    NPNCache loaded;
+    EXPECT_FALSE(loaded.load(path));
+    EXPECT_EQ(0, loaded.size());
+    std::filesystem::remove(path);
+  }
+
+} // namespace eda::gate::optimizer
@@ -8,12 +8,15 @@
 
 #include "gate/optimizer/npn/npn_collector.h"
 #include "gate/optimizer/optimizer_util.h"
+#include "gate/optimizer/parallel_cuts_finder.h"
 #include "gate/model/examples.h"
 #include "gate/parser/graphml.h"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <chrono>
 #include <ctime>
 
@@ -142,6 +145,174 @@ namespace eda::gate::optimizer::npn {
     printNetCones("gnet3", npn.getEssentialCones(10, 10), &net, "gnet3");
   }
 
+  TEST(NpnTest, parallelProcess) {
+    GNet net;
+    gnet3(net);
+    NPNCollector serial(&net);
+    serial.process(4, CutsFindVisitor::ALL_CUTS);
+    NPNCollector parallel(&net);
+    parallel.process(4, CutsFindVisitor::ALL_CUTS, 4);
+
+    std::stringstream serialData, parallelData;
+    serial.printHistogramData(serialData);
+    parallel.printHistogramData(parallelData);
+    EXPECT_EQ(serialData.str(), parallelData.str());
+  }
+
+  TEST(NpnTest, priorityCutsNumbers) {
+    GNet net;
+    gnet3(net);
+    LeafCountCost cost;
+
+    // ALL_CUTS does not bound the number of cuts passed to process().
+    NPNCollector byProcess(&net);
+    byProcess.usePriorityCuts(&cost, CutsFindVisitor::ALL_CUTS);
+    byProcess.process(4, 5);
+    NPNCollector byPriority(&net);
+    byPriority.usePriorityCuts(&cost, 5);
+    byPriority.process(4, CutsFindVisitor::ALL_CUTS);
+
+    std::stringstream processData, priorityData;
+    byProcess.printHistogramData(processData);
+    byPriority.printHistogramData(priorityData);
+    EXPECT_EQ(priorityData.str(), processData.str());
+  }
+
+  TEST(NpnTest, coneArenaGenerations) {
+    GNet net;
+    gnet3(net);
+    NPNCollector npn(&net);
+    npn.useConeArena(nullptr);
+    npn.process(4, CutsFindVisitor::ALL_CUTS);
+    EXPECT_EQ(0, npn.getConeArena().getStats().nets);
+
+    auto cones = npn.getEssentialCones(2, 2);
+    const size_t nets = npn.getConeArena().getStats().liveNets;
+    auto next = npn.getEssentialCones(2, 2);
+    EXPECT_EQ(nets, npn.getConeArena().getStats().liveNets);
+    EXPECT_EQ(2, npn.getConeArena().getStats().releases);
+    // The cones of the first call are still valid.
+    for (const auto &[npnClass, classCones]: cones) {
+      for (const auto &cone: classCones) {
+        EXPECT_NE(0, cone->nGates());
+      }
+    }
+  }
+
+  TEST(NpnTest, essentialConesBeyondSamples) {
+    GNet net;
+    gnet3(net);
+    NPNCollector recorded(&net);
+    recorded.keepRecords(true);
+    recorded.setSamplesNumber(1);
+    recorded.process(4, CutsFindVisitor::ALL_CUTS);
+    NPNCollector sampled(&net);
+    sampled.setSamplesNumber(1);
+    sampled.process(4, CutsFindVisitor::ALL_CUTS);
+
+    // The cones beyond the samples are built from the records or
+    // from the cuts found again.
+    auto byRecords = recorded.getEssentialCones(3, 3);
+    auto bySamples = sampled.getEssentialCones(3, 3);
+    ASSERT_EQ(byRecords.size(), bySamples.size());
+    size_t conesNumber = 0;
+    for (const auto &[npnClass, cones]: byRecords) {
+      const auto &sampledCones = bySamples.at(npnClass);
+      ASSERT_EQ(cones.size(), sampledCones.size());
+      for (size_t i = 0; i < cones.size(); ++i) {
+        EXPECT_EQ(cones[i]->nGates(), sampledCones[i]->nGates());
+      }
+      conesNumber += cones.size();
+    }
+    EXPECT_GT(conesNumber, byRecords.size());
+  }
+
+  TEST(NpnTest, runningStats) {
+    RunningStats stats;
+    for (int value: {1, 2, 3, 4}) {
+      stats.add(value);
+    }
+    EXPECT_EQ(4, stats.n);
+    EXPECT_DOUBLE_EQ(2.5, stats.mean);
+    EXPECT_DOUBLE_EQ(std::sqrt(1.25), stats.deviation());
+  }
+
+  TEST(NpnTest, classifyCutWithAndWithoutTable) {
+    using Signal = base::model::Signal<GateId>;
+    using base::model::Event;
+
+    GNet net;
+    GateId a = net.addIn();
+    GateId b = net.addIn();
+    GateId andAB = net.addGate(model::GateSymbol::AND,
+                               {Signal(Event::ALWAYS, a),
+                                Signal(Event::ALWAYS, b)});
+    GateId orAB = net.addGate(model::GateSymbol::OR,
+                              {Signal(Event::ALWAYS, a),
+                               Signal(Event::ALWAYS, b)});
+    // a & (a | b) = a does not depend on b.
+    GateId absorbed = net.addGate(model::GateSymbol::AND,
+                                  {Signal(Event::ALWAYS, a),
+                                   Signal(Event::ALWAYS, orAB)});
+    net.addOut(andAB);
+    net.addOut(absorbed);
+
+    NPNCollector npn(&net);
+    Cut withTable{a, b};
+    withTable.setTruthTable(0x8888888888888888ull);
+    const Cut withoutTable{a, b};
+
+    NPNStats byTable, byCone;
+    ASSERT_TRUE(npn.classifyCut(withTable, andAB, byTable));
+    ASSERT_TRUE(npn.classifyCut(withoutTable, andAB, byCone));
+    EXPECT_EQ(byTable.npnClass, byCone.npnClass);
+    EXPECT_EQ(byTable.cut, byCone.cut);
+
+    // The cuts are not skipped if the function does not depend on a leaf.
+    Cut absorbedTable{a, b};
+    absorbedTable.setTruthTable(0xAAAAAAAAAAAAAAAAull);
+    ASSERT_TRUE(npn.classifyCut(absorbedTable, absorbed, byTable));
+    ASSERT_TRUE(npn.classifyCut(Cut{a, b}, absorbed, byCone));
+    EXPECT_EQ(byTable.npnClass, byCone.npnClass);
+  }
+
+  TEST(NpnTest, classifyCutWithConstantLeaf) {
+    using Signal = base::model::Signal<GateId>;
+    using base::model::Event;
+
+    GNet net;
+    GateId a = net.addIn();
+    GateId b = net.addIn();
+    GateId one = net.addGate(model::GateSymbol::ONE, {});
+    GateId andAB = net.addGate(model::GateSymbol::AND,
+                               {Signal(Event::ALWAYS, a),
+                                Signal(Event::ALWAYS, b)});
+    GateId xorOne = net.addGate(model::GateSymbol::XOR,
+                                {Signal(Event::ALWAYS, andAB),
+                                 Signal(Event::ALWAYS, one)});
+    net.addOut(xorOne);
+
+    ParallelCutsFinder finder(3, CutsFindVisitor::ALL_CUTS, nullptr, 1);
+    finder.setTruthTables(true);
+    CutStorage storage = finder.find(&net);
+    const auto &oneCuts = storage.cuts[one];
+    ASSERT_EQ(1, oneCuts.size());
+    EXPECT_EQ(~0ull, oneCuts.begin()->truthTable());
+
+    // The cut found by the enumeration carries the table.
+    const Cut leaves{a, b, one};
+    const auto &cuts = storage.cuts[xorOne];
+    auto found = std::find(cuts.begin(), cuts.end(), leaves);
+    ASSERT_NE(cuts.end(), found);
+    ASSERT_TRUE(found->hasTruthTable());
+
+    NPNCollector npn(&net);
+    NPNStats byTable, byCone;
+    ASSERT_TRUE(npn.classifyCut(*found, xorOne, byTable));
+    ASSERT_TRUE(npn.classifyCut(leaves, xorOne, byCone));
+    EXPECT_EQ(byTable.npnClass, byCone.npnClass);
+  }
+
   TEST(NpnTest, ethernetCone) {
     auto values = graphMLNPNStatistics(4, "ethernet");
     printNetCones("ethernet", values.first.getEssentialCones(10, 10),
@@ -10,9 +10,14 @@
 #include "gtest/gtest.h"
 #include "gate/printer/dot.h"
 #include "util/logging.h"
+#include "gate/optimizer/feature_extractor.h"
+#include "gate/optimizer/npn/npn_collector.h"
 #include "gate/optimizer/plain_parameters_collector.h"
 
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
+#include <sstream>
 #include <string>
 
 namespace eda::gate::optimizer {
@@ -60,4 +65,172 @@ namespace eda::gate::optimizer {
         delete gNet;
 }
 
+    TEST(PlainParametersCollectorTest, ac97CtrlLevelization) {
+        auto gNet = parseGraphMLAndCollectParameters("ac97_ctrl_orig.bench");
+
+        Levelization levelization(gNet);
+        PlainParametersCollector collector(gNet, &levelization);
+        collector.collect();
+        PlainParameters parameters = collector.getParameters();
+
+        int numAnds = 0;
+        for (const auto &link : gNet->gates()) {
+            numAnds += link->isAnd();
+        }
+        EXPECT_EQ(parameters.numAnds, numAnds);
+        EXPECT_EQ(parameters.longestPath + 1, (int)levelization.getDepth());
+
+        delete gNet;
+    }
+
+    TEST(FeatureExtractorTest, ac97Ctrl) {
+        auto gNet = parseGraphMLAndCollectParameters("ac97_ctrl_orig.bench");
+
+        Levelization levelization(gNet);
+        PlainParametersCollector collector(gNet, &levelization);
+        collector.collect();
+        PlainParameters parameters = collector.getParameters();
+
+        FeatureExtractor extractor;
+        std::vector<float> row = extractor.extract(gNet, &levelization);
+        ASSERT_EQ(row.size(), extractor.getNames().size());
+
+        EXPECT_EQ(row[0], parameters.numInputs);
+        EXPECT_EQ(row[1], parameters.numOutputs);
+        EXPECT_EQ(row[2], parameters.numGates);
+        EXPECT_EQ(row[3], parameters.numAnds);
+        EXPECT_EQ(row[4], parameters.numInvertedEdges);
+        EXPECT_EQ(row[5], parameters.longestPath);
+
+        std::stringstream stream;
+        FeatureExtractor::writeRow(stream, row.data(), row.size());
+        std::vector<float> read;
+        ASSERT_TRUE(FeatureExtractor::readRow(stream, read));
+        EXPECT_EQ(read, row);
+        EXPECT_FALSE(FeatureExtractor::readRow(stream, read));
+
+        delete gNet;
+    }
+
+    TEST(FeatureExtractorTest, handBuiltNet) {
+        using Signal = base::model::Signal<GNet::GateId>;
+        using base::model::Event;
+
+        // y = XOR(a, b) & MAJ(a, b, c) is reconvergent on a and b.
+        GNet net;
+        auto a = net.addIn();
+        auto b = net.addIn();
+        auto c = net.addIn();
+        auto x = net.addGate(model::GateSymbol::XOR,
+                             {Signal(Event::ALWAYS, a),
+                              Signal(Event::ALWAYS, b)});
+        auto m = net.addGate(model::GateSymbol::MAJ,
+                             {Signal(Event::ALWAYS, a),
+                              Signal(Event::ALWAYS, b),
+                              Signal(Event::ALWAYS, c)});
+        auto y = net.addGate(model::GateSymbol::AND,
+                             {Signal(Event::ALWAYS, x),
+                              Signal(Event::ALWAYS, m)});
+        auto n = net.addGate(model::GateSymbol::NOT, {Signal(Event::ALWAYS, y)});
+        net.addOut(n);
+        net.addOut(m);
+
+        // A width bin per level: 3, 2 (x, m), 2 (y, out), 1 (n), 1 (out).
+        FeatureExtractor extractor(FeatureOptions{5, 4});
+        const auto &names = extractor.getNames();
+        std::vector<float> row = extractor.extract(&net);
+        ASSERT_EQ(row.size(), names.size());
+        auto feature = [&](const std::string &name) {
+            auto i = std::find(names.begin(), names.end(), name);
+            EXPECT_NE(i, names.end()) << name;
+            return i == names.end() ? NAN : row[i - names.begin()];
+        };
+
+        EXPECT_EQ(3, feature("inputs"));
+        EXPECT_EQ(2, feature("outputs"));
+        EXPECT_EQ(9, feature("gates"));
+        EXPECT_EQ(1, feature("ands"));
+        EXPECT_EQ(1, feature("inverted_edges"));
+        EXPECT_EQ(4, feature("depth"));
+
+        for (const char *name: {"ratio_and", "ratio_xor", "ratio_maj",
+                                "ratio_not"}) {
+            EXPECT_FLOAT_EQ(0.25f, feature(name)) << name;
+        }
+        for (const char *name: {"ratio_or", "ratio_buf", "ratio_other"}) {
+            EXPECT_EQ(0, feature(name)) << name;
+        }
+
+        EXPECT_EQ(3, feature("width_max"));
+        EXPECT_FLOAT_EQ(9.f / 5, feature("width_mean"));
+        const float widths[] = {3, 2, 2, 1, 1};
+        for (size_t i = 0; i < std::size(widths); ++i) {
+            EXPECT_FLOAT_EQ(widths[i] / 9,
+                            feature("width_bin_" + std::to_string(i)));
+        }
+
+        // Fanouts of the 7 drivers: a, b, m = 2 and c, x, y, n = 1.
+        EXPECT_FLOAT_EQ(10.f / 7, feature("fanout_mean"));
+        EXPECT_FLOAT_EQ(std::sqrt(12.f) / 7, feature("fanout_std"));
+        EXPECT_FLOAT_EQ(1 / std::sqrt(12.f), feature("fanout_skew"));
+        EXPECT_EQ(2, feature("fanout_max"));
+        EXPECT_FLOAT_EQ(3.f / 7, feature("fanout_stems"));
+
+        EXPECT_EQ(1, feature("reconv_gates"));
+        EXPECT_FLOAT_EQ(0.25f, feature("reconv_ratio"));
+
+        // The critical path is a -> x -> y -> n -> out.
+        EXPECT_EQ(3, feature("path_length"));
+        for (const char *name: {"path_xor", "path_and", "path_not"}) {
+            EXPECT_FLOAT_EQ(1.f / 3, feature(name)) << name;
+        }
+        for (const char *name: {"path_or", "path_maj", "path_buf",
+                                "path_other"}) {
+            EXPECT_EQ(0, feature(name)) << name;
+        }
+
+        for (const char *name: {"npn_classes", "npn_top_share", "npn_bin_0",
+                                "npn_bin_1", "npn_bin_2", "npn_bin_3"}) {
+            EXPECT_EQ(0, feature(name)) << name;
+        }
+
+        // The NPN bins are the shares of the classes.
+        NPNCollector npn(&net);
+        npn.process(3, CutsFindVisitor::ALL_CUTS);
+        const auto &statistics = npn.getNPNStatistics();
+        size_t total = 0, top = 0;
+        for (const auto &[npnClass, data]: statistics) {
+            total += data.count;
+            top = std::max(top, data.count);
+        }
+        ASSERT_GT(total, 0);
+
+        row = extractor.extract(&net, nullptr, &npn);
+        EXPECT_EQ(statistics.size(), feature("npn_classes"));
+        EXPECT_FLOAT_EQ(static_cast<float>(top) / total,
+                        feature("npn_top_share"));
+        float shares = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            shares += feature("npn_bin_" + std::to_string(i));
+        }
+        EXPECT_FLOAT_EQ(1.f, shares);
+        EXPECT_EQ(9, feature("gates"));
+    }
+
+    TEST(FeatureExtractorTest, malformedRow) {
+        const float row[] = {1.f, 2.f, 3.f};
+        std::stringstream stream;
+        FeatureExtractor::writeRow(stream, row, std::size(row));
+        std::string data = stream.str();
+
+        // The count claims more features than the stream holds.
+        const uint32_t count = 1 << 30;
+        data.replace(0, sizeof(count), reinterpret_cast<const char*>(&count),
+                     sizeof(count));
+        std::stringstream malformed(data);
+        std::vector<float> read;
+        EXPECT_FALSE(FeatureExtractor::readRow(malformed, read));
+        EXPECT_TRUE(read.empty());
+    }
+
 } // namespace eda::gate::optimizer
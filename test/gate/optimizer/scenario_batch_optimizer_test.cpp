@@ -0,0 +1,220 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the Utopia EDA Project, under the Apache License v2.0
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 ISP RAS (http://www.ispras.ru)
+//
+//===----------------------------------------------------------------------===//
+
+#include "gate/optimizer/feature_extractor.h"
+#include "gate/optimizer/native_predictor.h"
+#include "gate/optimizer/plain_parameters_collector.h"
+#include "gate/optimizer/scenario_batch_optimizer.h"
+#include "gate/optimizer/synthesis_scenario_optimizer.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace eda::gate::optimizer {
+
+  using Predictor = NativeScenarioPredictor;
+
+  static const std::filesystem::path designsPath =
+      std::filesystem::path("test") / "data" / "gate" / "parser" /
+      "graphml" / "OpenABC" / "graphml_openabcd";
+
+  static const std::vector<std::string> designNames = {
+    "ac97_ctrl_orig.bench.graphml", "i2c_orig.bench.graphml"
+  };
+
+  static const int32_t gatesIndex = [] {
+    FeatureExtractor extractor;
+    const auto &names = extractor.getNames();
+    return std::find(names.begin(), names.end(), "gates") - names.begin();
+  }();
+
+  // The designs with fewer gates than the threshold prefer "rw",
+  // the other ones prefer "b", and the shorter scenarios are preferred.
+  static std::unique_ptr<Predictor> makeModel(size_t width, float threshold) {
+    const int32_t rw = width, b = width + 1, steps = width + 2;
+
+    auto model = std::make_unique<Predictor>(
+        Predictor::GBDT, width, std::vector<std::string>{"rw", "b"});
+    model->addTree({{gatesIndex, threshold, 1, 2},
+                    {rw, 0.5f, 3, 4}, {b, 0.5f, 5, 6},
+                    {-1, 1.f, 0, 0}, {-1, 3.f, 0, 0},
+                    {-1, 1.f, 0, 0}, {-1, 4.f, 0, 0}});
+    model->addTree({{steps, 1.5f, 1, 2}, {-1, 0.5f, 0, 0}, {-1, 0.f, 0, 0}});
+    return model;
+  }
+
+  static std::string readFile(const std::filesystem::path &path) {
+    std::ifstream infile(path);
+    std::stringstream buffer;
+    buffer << infile.rdbuf();
+    return buffer.str();
+  }
+
+  TEST(ScenarioBatchOptimizerTest, SameForChunksAndBatches) {
+    if (!getenv("UTOPIA_HOME")) {
+      FAIL() << "UTOPIA_HOME is not set.";
+    }
+    const auto home = std::filesystem::path(getenv("UTOPIA_HOME"));
+    const auto directory =
+        std::filesystem::temp_directory_path() / "scenario_batch_optimizer";
+    std::filesystem::create_directories(directory);
+
+    // The relative path is resolved against the manifest directory.
+    const auto manifest = directory / "manifest.txt";
+    {
+      std::ofstream outfile(manifest);
+      outfile << "# Designs\n"
+              << (home / designsPath / designNames[0]).string() << "\n"
+              << "missing.graphml\n\n"
+              << (home / designsPath / designNames[1]).string() << "\n";
+    }
+    const auto scenarios = directory / "scenarios.txt";
+    {
+      std::ofstream outfile(scenarios);
+      outfile << "s1:rw\ns2:b\ns3:rw; b\ns4:fraig\n";
+    }
+
+    // The threshold is between the numbers of the gates of the designs.
+    ScenarioBatchOptimizer reader;
+    reader.readManifest(manifest.string());
+    reader.collectFeatures();
+    const auto &read = reader.getDesigns();
+    ASSERT_EQ(3, read.size());
+    ASSERT_FALSE(read[0].features.empty());
+    ASSERT_TRUE(read[1].features.empty());
+    ASSERT_FALSE(read[2].features.empty());
+    const size_t width = read[0].features.size();
+    const float gates0 = read[0].features[gatesIndex];
+    const float gates2 = read[2].features[gatesIndex];
+    ASSERT_NE(gates0, gates2);
+    const float threshold = (gates0 + gates2) / 2;
+
+    // Scores: s1 = 3.5, s2 = 1.5, s3 = 3, s4 = 1.5 for the small design;
+    // s1 = 1.5, s2 = 4.5, s3 = 4, s4 = 1.5 for the large one.
+    const std::vector<size_t> smallBest = {0, 2}, largeBest = {1, 2};
+    const std::vector<double> smallQualities = {3.5, 3};
+    const std::vector<double> largeQualities = {4.5, 4};
+    const bool isSmall0 = gates0 < gates2;
+
+    std::vector<std::string> outputs;
+    for (const auto &[chunk, batch]: std::vector<std::pair<size_t, size_t>>{
+             {1, 1}, {2, 1}, {3, 2}, {32, 16}}) {
+      ScenarioBatchOptimizer optimizer(makeModel(width, threshold), 2);
+      optimizer.setChunkSize(chunk);
+      optimizer.setBatchSize(batch);
+      optimizer.readManifest(manifest.string());
+      optimizer.readSynthesisScenarios(scenarios.string());
+
+      const auto output = directory / ("best_" + std::to_string(chunk) + "_" +
+                                       std::to_string(batch) + ".txt");
+      optimizer.evaluateAndSelectBestScenarios(2, output.string());
+
+      const auto &designs = optimizer.getDesigns();
+      ASSERT_EQ(3, designs.size());
+      EXPECT_EQ(read[0].features, designs[0].features);
+      EXPECT_EQ(read[2].features, designs[2].features);
+      EXPECT_EQ(isSmall0 ? smallBest : largeBest, designs[0].best);
+      EXPECT_EQ(isSmall0 ? smallQualities : largeQualities,
+                designs[0].qualities);
+      EXPECT_TRUE(designs[1].best.empty());
+      EXPECT_TRUE(designs[1].qualities.empty());
+      EXPECT_EQ(isSmall0 ? largeBest : smallBest, designs[2].best);
+      EXPECT_EQ(isSmall0 ? largeQualities : smallQualities,
+                designs[2].qualities);
+      outputs.push_back(readFile(output));
+    }
+
+    const std::string small = "s1: rw\ns3: rw; b\n";
+    const std::string large = "s2: b\ns3: rw; b\n";
+    const std::string expected =
+        "# " + (home / designsPath / designNames[0]).string() + "\n" +
+        (isSmall0 ? small : large) +
+        "# " + (home / designsPath / designNames[1]).string() + "\n" +
+        (isSmall0 ? large : small);
+    for (const auto &output: outputs) {
+      EXPECT_EQ(expected, output);
+    }
+  }
+
+  TEST(ScenarioBatchOptimizerTest, PlainParameterColumns) {
+    if (!getenv("UTOPIA_HOME")) {
+      FAIL() << "UTOPIA_HOME is not set.";
+    }
+    const auto home = std::filesystem::path(getenv("UTOPIA_HOME"));
+    const auto design = home / designsPath / designNames[0];
+
+    FeatureExtractor extractor;
+    const auto &names = extractor.getNames();
+    const std::vector<std::string> expected = {
+      "inputs", "outputs", "ands", "inverted_edges", "depth"
+    };
+    ASSERT_EQ(expected.size(), std::size(PLAIN_PARAMETER_COLUMNS));
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_LT(PLAIN_PARAMETER_COLUMNS[i], names.size());
+      EXPECT_EQ(expected[i], names[PLAIN_PARAMETER_COLUMNS[i]]);
+    }
+
+    // The batched rows carry the same numbers as the plain parameters.
+    ScenarioBatchOptimizer optimizer;
+    const auto manifest =
+        std::filesystem::temp_directory_path() / "plain_parameter_columns.txt";
+    {
+      std::ofstream outfile(manifest);
+      outfile << design.string() << "\n";
+    }
+    optimizer.readManifest(manifest.string());
+    optimizer.collectFeatures();
+    const auto &features = optimizer.getDesigns().front().features;
+    ASSERT_EQ(names.size(), features.size());
+
+    std::unique_ptr<model::GNet> net(readGraphMLNet(design.string()));
+    ASSERT_NE(nullptr, net);
+    Levelization levelization(net.get());
+    PlainParametersCollector collector(net.get(), &levelization);
+    collector.collect();
+    const auto &parameters = collector.getParameters();
+    const std::vector<int> values = {
+      parameters.numInputs, parameters.numOutputs, parameters.numAnds,
+      parameters.numInvertedEdges, parameters.longestPath
+    };
+    for (size_t i = 0; i < values.size(); ++i) {
+      EXPECT_EQ(values[i], features[PLAIN_PARAMETER_COLUMNS[i]]) << expected[i];
+    }
+  }
+
+  TEST(ScenarioBatchOptimizerTest, SingleNetWithoutCollectParameters) {
+    if (!getenv("UTOPIA_HOME")) {
+      FAIL() << "UTOPIA_HOME is not set.";
+    }
+    const auto home = std::filesystem::path(getenv("UTOPIA_HOME"));
+    const auto design = home / designsPath / designNames[0];
+    const auto directory =
+        std::filesystem::temp_directory_path() / "scenario_batch_optimizer";
+    std::filesystem::create_directories(directory);
+    const auto scenarios = directory / "single_scenarios.txt";
+    {
+      std::ofstream outfile(scenarios);
+      outfile << "s1:rw\ns2:b\n";
+    }
+
+    // The features are extracted on the evaluation: the design is below
+    // the threshold, so "rw" is the best scenario.
+    SynthesisScenarioOptimizer optimizer(
+        makeModel(FeatureExtractor().size(), 1e9f));
+    optimizer.readGraphML(design.string());
+    optimizer.readSynthesisScenarios(scenarios.string());
+    const auto output = directory / "single_best.txt";
+    optimizer.evaluateAndSelectBestScenarios(1, output.string());
+    EXPECT_EQ("s1: rw\n", readFile(output));
+  }
+
+} // namespace eda::gate::optimizer
@@ -7,11 +7,18 @@
 //===----------------------------------------------------------------------===//
 
 #include "gate/model/examples.h"
+#include "gate/optimizer/dominator_tree.h"
 #include "gate/optimizer/optimizer_util.h"
+#include "gate/optimizer/thread_pool.h"
 #include "gate/optimizer/util.h"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <unordered_set>
+
 using namespace eda::gate::parser;
 
 namespace eda::gate::optimizer {
@@ -76,4 +83,180 @@ namespace eda::gate::optimizer {
     EXPECT_EQ(15, net.nGates());
   }
 
+  TEST(CsrGraphTest, SameAsGates) {
+    GNet net;
+    auto g = gnet3(net);
+    CsrGraph graph(net);
+
+    ASSERT_EQ(net.nGates(), graph.size());
+    for (const auto *gate: net.gates()) {
+      auto index = graph.indexOf(gate->id());
+      ASSERT_NE(CsrGraph::NO_INDEX, index);
+      EXPECT_EQ(gate->id(), graph.gateId(index));
+
+      std::vector<GateId> fanins, fanouts;
+      for (auto fanin: graph.fanins(index)) {
+        fanins.push_back(graph.gateId(fanin));
+      }
+      for (auto fanout: graph.fanouts(index)) {
+        fanouts.push_back(graph.gateId(fanout));
+      }
+      EXPECT_EQ(getNext(gate->id(), false), fanins);
+      EXPECT_EQ(getNext(gate->id(), true), fanouts);
+    }
+
+    ConeSet expected, actual;
+    getConeSet(g.back(), expected, false);
+    getConeSet(graph, g.back(), actual, false);
+    EXPECT_EQ(expected, actual);
+  }
+
+  TEST(LevelizationTest, LevelsAreConsistent) {
+    GNet net;
+    gnet3(net);
+    Levelization levelization(&net);
+
+    const auto &order = levelization.getOrder();
+    ASSERT_EQ(net.nGates(), order.size());
+
+    size_t nGates = 0;
+    const auto &levels = levelization.getLevels();
+    for (size_t level = 0; level < levels.size(); ++level) {
+      for (auto gate: levels[level]) {
+        EXPECT_EQ(level, levelization.getLevel(gate));
+        size_t maxFanin = 0;
+        bool hasFanins = false;
+        for (auto fanin: getNext(gate, false)) {
+          EXPECT_LT(levelization.getLevel(fanin), level);
+          maxFanin = std::max(maxFanin, levelization.getLevel(fanin));
+          hasFanins = true;
+        }
+        EXPECT_EQ(hasFanins ? maxFanin + 1 : 0, level);
+      }
+      nGates += levels[level].size();
+    }
+    EXPECT_EQ(net.nGates(), nGates);
+    EXPECT_EQ(findDominators(order), findDominators(levelization));
+  }
+
+  TEST(LevelizationTest, StaleOrder) {
+    using Signal = base::model::Signal<GateId>;
+    using base::model::Event;
+
+    GNet net;
+    GateId a = net.addIn();
+    GateId b = net.addIn();
+    GateId first = net.addGate(model::GateSymbol::AND,
+                               {Signal(Event::ALWAYS, a),
+                                Signal(Event::ALWAYS, b)});
+    GateId second = net.addGate(model::GateSymbol::OR,
+                                {Signal(Event::ALWAYS, a),
+                                 Signal(Event::ALWAYS, b)});
+    Levelization levelization(&net);
+    EXPECT_TRUE(levelization.checkOrder());
+
+    // The gate is reconnected to the gate that follows it in the order.
+    const auto &order = levelization.getOrder();
+    const bool firstBefore =
+        std::find(order.begin(), order.end(), first) <
+        std::find(order.begin(), order.end(), second);
+    const GateId earlier = firstBefore ? first : second;
+    const GateId later = firstBefore ? second : first;
+    net.setGate(earlier, model::GateSymbol::AND,
+                {Signal(Event::ALWAYS, a), Signal(Event::ALWAYS, later)});
+    EXPECT_FALSE(levelization.checkOrder());
+
+    levelization.invalidate();
+    EXPECT_TRUE(levelization.checkOrder());
+    EXPECT_EQ(levelization.getLevel(later) + 1,
+              levelization.getLevel(earlier));
+  }
+
+  TEST(ConeLimitsTest, BoundedCone) {
+    GNet net;
+    auto g = gnet3(net);
+
+    ConeSet full;
+    getConeSet(g.back(), full, false);
+
+    ConeSet vertex;
+    EXPECT_EQ(CONE_DEPTH_LIMIT,
+              getConeSet(g.back(), vertex, false, ConeLimits{0, 100}));
+    EXPECT_EQ(ConeSet{g.back()}, vertex);
+
+    ConeSet small;
+    EXPECT_EQ(CONE_SIZE_LIMIT,
+              getConeSet(g.back(), small, false,
+                         ConeLimits{ConeLimits::NO_LIMIT, 3}));
+    EXPECT_EQ(3, small.size());
+
+    ConeSet bounded;
+    EXPECT_EQ(CONE_COMPLETE,
+              getConeSet(g.back(), bounded, false,
+                         ConeLimits{ConeLimits::NO_LIMIT, full.size()}));
+    EXPECT_EQ(full, bounded);
+  }
+
+  TEST(ThreadPoolTest, RethrowsTaskException) {
+    ThreadPool pool(4);
+    auto task = [](size_t i, size_t) {
+      if (i % 10 == 9) {
+        throw std::runtime_error("Task failed");
+      }
+    };
+    EXPECT_THROW(pool.parallelFor(1000, task), std::runtime_error);
+
+    // The pool is usable after the exception.
+    std::atomic<size_t> sum{0};
+    pool.parallelFor(100, [&](size_t i, size_t) { sum += i; });
+    EXPECT_EQ(4950, sum);
+  }
+
+  // Nodes reachable from the sources if the removed node is cut out.
+  static std::unordered_set<GateId> reachWithout(
+      const std::vector<GateId> &order, GateId removed) {
+    std::unordered_set<GateId> reached;
+    std::vector<GateId> stack;
+    for (auto node: order) {
+      if (node != removed && getNext(node, false).empty()) {
+        reached.insert(node);
+        stack.push_back(node);
+      }
+    }
+    while (!stack.empty()) {
+      GateId node = stack.back();
+      stack.pop_back();
+      for (auto next: getNext(node, true)) {
+        if (next != removed && reached.insert(next).second) {
+          stack.push_back(next);
+        }
+      }
+    }
+    return reached;
+  }
+
+  TEST(DominatorTreeTest, BruteForce) {
+    GNet net;
+    gnet3(net);
+    Levelization levelization(&net);
+    const auto &order = levelization.getOrder();
+
+    // D dominates N iff N is not reachable from the sources without D.
+    DominatorTree tree(levelization);
+    for (auto dominator: order) {
+      auto reached = reachWithout(order, dominator);
+      for (auto node: order) {
+        EXPECT_EQ(node == dominator || !reached.count(node),
+                  tree.dominates(dominator, node));
+      }
+    }
+    for (auto node: order) {
+      auto idom = tree.getIdom(node);
+      if (idom != DominatorTree::NO_DOMINATOR) {
+        EXPECT_TRUE(tree.dominates(idom, node));
+        EXPECT_NE(idom, node);
+      }
+    }
+  }
+
 } // namespace eda::gate::optimizer